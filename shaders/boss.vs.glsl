@@ -14,8 +14,18 @@ uniform mat3 translate;
 uniform mat3 rotation;
 uniform mat3 scale;
 uniform mat3 transform;
-uniform mat3 projection;
-uniform float time;
+// Part of the bound texture this sprite covers, its atlas rectangle or the whole texture
+uniform vec4 uv_rect;
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
 uniform int inInvin;
 uniform vec2 velocityOfPlayerHit;
 uniform int playerDamage;
@@ -56,7 +66,7 @@ vec4 deathAnimation(vec3 pos) {
 void main()
 {
 	vpos = in_position.xy;
-	texcoord = in_texcoord;
+	texcoord = uv_rect.xy + in_texcoord * uv_rect.zw;
 	vec3 pos = projection * transform * vec3(in_position.xy, 1.0);
 	if (inInvin == 1) {
 		gl_Position = invincibilityAnimation(pos);
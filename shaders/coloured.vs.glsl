@@ -7,7 +7,16 @@ in vec3 in_position;
 
 // Application data
 uniform mat3 transform;
-uniform mat3 projection;
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
 
 void main()
 {
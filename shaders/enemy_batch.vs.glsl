@@ -0,0 +1,94 @@
+#version 330
+
+// The SPRITE quad
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_texcoord;
+
+// One per enemy
+layout(location = 2) in vec2 in_translate;
+layout(location = 3) in vec2 in_scale;
+layout(location = 4) in float in_angle;
+layout(location = 5) in int in_flags;
+layout(location = 6) in vec4 in_frame;
+layout(location = 7) in vec3 in_tint;
+layout(location = 8) in float in_color_scale;
+layout(location = 9) in vec2 in_hit_velocity;
+layout(location = 10) in float in_hit_damage;
+layout(location = 11) in float in_animation_time;
+
+// Passed to fragment shader
+out vec2 texcoord;
+out vec2 vpos;
+out vec2 world_pos;
+out vec3 tint;
+out float color_scale;
+flat out int inInvin;
+
+// Application data
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
+
+const int FLAG_INVINCIBLE = 1;
+const int FLAG_DEAD = 2;
+const int FLAG_CUT = 4;
+
+// translate * rotation * scale, as Transform builds it on the CPU
+mat3 spriteTransform(vec2 scale)
+{
+	float c = cos(in_angle);
+	float s = sin(in_angle);
+	return mat3(vec3(c * scale.x, s * scale.x, 0.0), vec3(-s * scale.y, c * scale.y, 0.0), vec3(in_translate, 1.0));
+}
+
+vec4 invincibilityAnimation(vec3 pos) {
+	float knockBackDistance = 0.1;
+	float knockBackPlayerDamageModifier = 0.02;
+	pos.x = pos.x + (sin(time) + 1.0) / 2.0 * (knockBackDistance * in_hit_velocity.x + knockBackPlayerDamageModifier * in_hit_damage);
+	pos.y = pos.y + (sin(time) + 1.0) / 2.0 * (knockBackDistance * in_hit_velocity.y + knockBackPlayerDamageModifier * in_hit_damage);
+	float shakeDistance = 0.01;
+	float shakeFrequencyModifier = 5.0;
+	return vec4(pos.x + shakeDistance * cos(time * shakeFrequencyModifier), pos.y + shakeDistance * sin(time * shakeFrequencyModifier),  in_position.z, 1.0);
+}
+
+vec4 deathAnimation(vec3 pos) {
+	if ((in_flags & FLAG_CUT) != 0) {
+		float cutDistance = 0.1;
+		if (gl_VertexID == 0 || gl_VertexID == 3 || gl_VertexID == 1) {
+			pos.x = pos.x - cutDistance * in_animation_time;
+			pos.y = pos.y - cutDistance * in_animation_time;
+		} else {
+			pos.x = pos.x + cutDistance * in_animation_time;
+			pos.y = pos.y + cutDistance * in_animation_time;
+		}
+	} else {
+		pos = projection * spriteTransform(in_scale * (1.0 - in_animation_time)) * vec3(in_position.xy, 1.0);
+	}
+	return vec4(pos.xy,  in_position.z, 1.0);
+}
+
+void main()
+{
+	vpos = in_position.xy;
+	texcoord = in_frame.xy + in_texcoord * in_frame.zw;
+	tint = in_tint;
+	color_scale = in_color_scale;
+	inInvin = (in_flags & FLAG_INVINCIBLE) != 0 ? 1 : 0;
+	vec3 pos = projection * spriteTransform(in_scale) * vec3(in_position.xy, 1.0);
+	if (inInvin == 1) {
+		gl_Position = invincibilityAnimation(pos);
+	} else if ((in_flags & FLAG_DEAD) != 0) {
+		gl_Position = deathAnimation(pos);
+	}
+	else {
+		gl_Position = vec4(pos.xy,  in_position.z, 1.0);
+	}
+	world_pos = gl_Position.xy;
+}
@@ -15,10 +15,20 @@ uniform mat3 translate;
 uniform mat3 rotation;
 uniform mat3 scale;
 uniform mat3 transform;
-uniform mat3 projection;
+// Part of the bound texture this sprite covers, its atlas rectangle or the whole texture
+uniform vec4 uv_rect;
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
 uniform int xFrame;
 uniform int yFrame;
-uniform float time;
 uniform int inInvin;
 uniform int isDead;
 uniform float animationTime;
@@ -53,6 +63,7 @@ void main()
 	texcoord.y = texcoord.y * yScale * 0.9;
 	texcoord.y += yScale * yFrame;
 	texcoord.y += yShift;
+	texcoord = uv_rect.xy + texcoord * uv_rect.zw;
 	
 	
 	vec3 pos = projection * transform * vec3(in_position.xy, 1.0);
@@ -9,7 +9,18 @@ out vec2 texcoord;
 
 // Application data
 uniform mat3 transform;
-uniform mat3 projection;
+// Part of the bound texture this sprite covers, its atlas rectangle or the whole texture
+uniform vec4 uv_rect;
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
 uniform int frame;
 
 void main()
@@ -18,6 +29,7 @@ void main()
 	texcoord = in_texcoord;
 	texcoord.x = texcoord.x * scale;
 	texcoord.x += scale * frame;
+	texcoord = uv_rect.xy + texcoord * uv_rect.zw;
 	vec3 pos = projection * transform * vec3(in_position.xy, 1.0);
 	gl_Position = vec4(pos.xy, in_position.z, 1.0);
 }
\ No newline at end of file
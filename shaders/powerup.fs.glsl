@@ -7,11 +7,16 @@ in vec2 world_pos;
 // Application data
 uniform sampler2D sampler0;
 uniform vec3 fcolor;
-uniform vec3 ambient_light;
-uniform vec2 light_source_pos;
-uniform vec3 light_col;
-uniform float light_intensity;
-uniform int in_shop;
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
 
 // Output color
 layout(location = 0) out  vec4 color;
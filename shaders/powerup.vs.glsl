@@ -10,12 +10,22 @@ out vec2 world_pos;
 
 // Application data
 uniform mat3 transform;
-uniform mat3 projection;
-uniform float time;
+// Part of the bound texture this sprite covers, its atlas rectangle or the whole texture
+uniform vec4 uv_rect;
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
 
 void main()
 {
-	texcoord = in_texcoord;
+	texcoord = uv_rect.xy + in_texcoord * uv_rect.zw;
 	vec3 pos = projection * transform * vec3(in_position.x, in_position.y, 1.0);
 	gl_Position = vec4(pos.x, pos.y + 0.01 * sin(time), in_position.z, 1.0);
 	world_pos = gl_Position.xy;
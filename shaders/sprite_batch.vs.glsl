@@ -0,0 +1,51 @@
+#version 330
+
+// The SPRITE quad
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_texcoord;
+
+// One per sprite
+layout(location = 2) in vec2 in_translate;
+layout(location = 3) in vec2 in_scale;
+layout(location = 4) in float in_angle;
+layout(location = 5) in int in_flags;
+layout(location = 6) in vec4 in_frame;
+layout(location = 7) in vec3 in_tint;
+
+// Passed to fragment shader
+out vec2 texcoord;
+out vec3 tint;
+out vec2 world_pos;
+flat out int lit;
+
+// Application data
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
+
+const int FLAG_UNLIT = 8;
+
+// translate * rotation * scale, as Transform builds it on the CPU
+mat3 spriteTransform(vec2 scale)
+{
+	float c = cos(in_angle);
+	float s = sin(in_angle);
+	return mat3(vec3(c * scale.x, s * scale.x, 0.0), vec3(-s * scale.y, c * scale.y, 0.0), vec3(in_translate, 1.0));
+}
+
+void main()
+{
+	texcoord = in_frame.xy + in_texcoord * in_frame.zw;
+	tint = in_tint;
+	lit = (in_flags & FLAG_UNLIT) != 0 ? 0 : 1;
+	vec3 pos = projection * spriteTransform(in_scale) * vec3(in_position.xy, 1.0);
+	gl_Position = vec4(pos.xy, in_position.z, 1.0);
+	world_pos = pos.xy;
+}
@@ -1,7 +1,16 @@
 #version 330
 
 uniform sampler2D screen_texture;
-uniform float time;
+// Per-frame constants, shared by every program
+layout(std140) uniform FrameConstants {
+	mat3 projection;
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+};
 uniform float brighten_screen_factor;
 uniform int game_over_factor;
 
@@ -0,0 +1,83 @@
+// internal
+#include "ai_lod.hpp"
+
+void AILodSelector::update() {
+	for (int i = 0; i < ai_lod_tier_count; i++) {
+		tierCounts[i] = 0;
+	}
+
+	// players in the shop cannot see or be reached by anything in the battle room
+	std::vector<vec2> playersInRoom;
+	for (uint i = 0; i < registry.players.size(); i++) {
+		if (i > 0 && !twoPlayer.inTwoPlayerMode) {
+			break;
+		}
+		Entity player = registry.players.entities[i];
+		if (!registry.inShops.has(player)) {
+			playersInRoom.push_back(registry.motions.get(player).position);
+		}
+	}
+
+	float reducedDistance = AI_LOD_REDUCED_DISTANCE * defaultResolution.scaling;
+	float fullDistance = AI_LOD_FULL_DISTANCE * defaultResolution.scaling;
+	for (uint i = 0; i < registry.enemies.size(); i++) {
+		Entity entity = registry.enemies.entities[i];
+		const Enemy& enemy = registry.enemies.components[i];
+		if (!registry.aiLods.has(entity)) {
+			registry.aiLods.emplace(entity);
+		}
+		AILod& lod = registry.aiLods.get(entity);
+		AI_LOD_TIER previousTier = lod.tier;
+
+		if (enemy.isDead || playersInRoom.empty()) {
+			lod.tier = AI_LOD_TIER::FROZEN;
+		}
+		else if (registry.enemyBoss.has(entity)) {
+			// the boss fills the room, it is always relevant
+			lod.tier = AI_LOD_TIER::FULL;
+		}
+		else {
+			vec2 position = registry.motions.get(entity).position;
+			float closestSq = -1.f;
+			for (vec2 playerPosition : playersInRoom) {
+				vec2 dp = playerPosition - position;
+				float distSq = dot(dp, dp);
+				if (closestSq < 0.f || distSq < closestSq) {
+					closestSq = distSq;
+				}
+			}
+			// coming back from frozen, start from the tier the current distance calls for
+			float threshold = lod.tier == AI_LOD_TIER::REDUCED ? fullDistance : reducedDistance;
+			lod.tier = closestSq > threshold * threshold ? AI_LOD_TIER::REDUCED : AI_LOD_TIER::FULL;
+		}
+
+		// no AI steers a frozen enemy, so stop it instead of letting physics carry it on its last velocity
+		if (lod.tier == AI_LOD_TIER::FROZEN && previousTier != AI_LOD_TIER::FROZEN) {
+			Motion& motion = registry.motions.get(entity);
+			lod.thawVelocity = motion.velocity;
+			motion.velocity = { 0, 0 };
+		}
+		else if (lod.tier != AI_LOD_TIER::FROZEN && previousTier == AI_LOD_TIER::FROZEN) {
+			registry.motions.get(entity).velocity = lod.thawVelocity;
+		}
+		tierCounts[(int)lod.tier]++;
+	}
+}
+
+AI_LOD_TIER getAILodTier(Entity entity) {
+	if (!registry.aiLods.has(entity)) {
+		return AI_LOD_TIER::FULL;
+	}
+	return registry.aiLods.get(entity).tier;
+}
+
+float aiLodElapsed(AI_LOD_TIER tier, float elapsed_ms) {
+	switch (tier) {
+	case AI_LOD_TIER::REDUCED:
+		return elapsed_ms * AI_LOD_REDUCED_RATE;
+	case AI_LOD_TIER::FROZEN:
+		return 0.f;
+	default:
+		return elapsed_ms;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// Enemies farther than this from every player in the battle room drop to the reduced tier (unscaled)
+const float AI_LOD_REDUCED_DISTANCE = 600.f;
+// and come back to full once closer than this, the gap keeps enemies on the edge from flickering
+const float AI_LOD_FULL_DISTANCE = 500.f;
+// Reduced enemies advance their think timers at this fraction of the frame time
+const float AI_LOD_REDUCED_RATE = 0.5f;
+
+// Picks an AI tier for every enemy from its state and where the players are:
+//   FULL    - near a player, runs everything
+//   REDUCED - far from every player, thinks at a slower cadence and keeps steering along its current plan
+//   FROZEN  - dead and animating, or no player is in the battle room, runs no AI and stands still
+// A tier change only scales or pauses the enemy's timers and a frozen enemy gets its velocity back
+// when it thaws, so it picks up where it left off
+class AILodSelector
+{
+public:
+	void update();
+
+	// Number of enemies in each tier after the last update, for profiling
+	int tierCounts[ai_lod_tier_count] = {};
+};
+
+// Tier of an entity, FULL for anything the selector does not track
+AI_LOD_TIER getAILodTier(Entity entity);
+// Frame time an entity in the given tier should advance its AI timers by
+float aiLodElapsed(AI_LOD_TIER tier, float elapsed_ms);
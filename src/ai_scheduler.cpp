@@ -0,0 +1,55 @@
+// internal
+#include "ai_scheduler.hpp"
+
+// stlib
+#include <algorithm>
+
+void scheduleAIThink(Entity entity, float interval, float firstDelay) {
+	AIThink& think = registry.aiThinks.emplace(entity);
+	think.interval = interval;
+	int bucket = entity.getId() % AI_THINK_BUCKETS;
+	think.timer = firstDelay + interval * bucket / AI_THINK_BUCKETS;
+}
+
+void scheduleAIThinks(const std::vector<Entity>& batch, float interval, float firstDelay) {
+	AIThink think;
+	think.interval = interval;
+	uint first = registry.aiThinks.insertBatch(batch, think);
+	for (uint i = 0; i < batch.size(); i++) {
+		Entity entity = batch[i];
+		int bucket = entity.getId() % AI_THINK_BUCKETS;
+		registry.aiThinks.components[first + i].timer = firstDelay + interval * bucket / AI_THINK_BUCKETS;
+	}
+}
+
+void AIScheduler::update(float elapsed_ms) {
+	due.clear();
+	for (uint i = 0; i < registry.aiThinks.size(); i++) {
+		AIThink& think = registry.aiThinks.components[i];
+		think.thinkNow = false;
+		Entity entity = registry.aiThinks.entities[i];
+		// reduced agents think less often and frozen ones (dead, or no player around) not at all
+		AI_LOD_TIER tier = getAILodTier(entity);
+		think.timer -= aiLodElapsed(tier, elapsed_ms);
+		if (think.timer <= 0.f && tier != AI_LOD_TIER::FROZEN) {
+			due.push_back({ think.timer, (int)i });
+		}
+	}
+
+	int thinkCount = (int)due.size();
+	if (maxAgentsPerFrame > 0 && thinkCount > maxAgentsPerFrame) {
+		thinkCount = maxAgentsPerFrame;
+		std::nth_element(due.begin(), due.begin() + thinkCount, due.end());
+	}
+	for (int i = 0; i < thinkCount; i++) {
+		AIThink& think = registry.aiThinks.components[due[i].second];
+		think.thinkNow = true;
+		// keep the phase so deferred agents do not drift, but drop thinks missed by more than a whole interval
+		think.timer += think.interval;
+		if (think.timer <= 0.f) {
+			think.timer = think.interval;
+		}
+	}
+	lastThinkCount = thinkCount;
+	lastDeferredCount = (int)due.size() - thinkCount;
+}
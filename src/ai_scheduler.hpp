@@ -0,0 +1,37 @@
+#pragma once
+
+// stlib
+#include <vector>
+
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+#include "ai_lod.hpp"
+
+// Agents are spread over this many phase buckets by entity id
+const int AI_THINK_BUCKETS = 8;
+
+// Gives an agent an AIThink cadence. The first think comes after firstDelay plus the agent's bucket
+// offset, so agents spawned on the same frame do not all think on the same frame
+void scheduleAIThink(Entity entity, float interval, float firstDelay);
+// Same as scheduleAIThink for a whole spawn batch
+void scheduleAIThinks(const std::vector<Entity>& batch, float interval, float firstDelay);
+
+// Hands out think ticks to every agent with an AIThink component. Each agent keeps its configured
+// cadence on average. When more agents are due than the per-frame budget allows, the most overdue
+// think first and the rest are deferred to the next frame
+class AIScheduler
+{
+public:
+	// 0 means no limit, the default so every agent thinks exactly on its cadence
+	int maxAgentsPerFrame = 0;
+
+	void update(float elapsed_ms);
+
+	// Stats of the last update, for profiling
+	int lastThinkCount = 0;
+	int lastDeferredCount = 0;
+
+private:
+	// (timer, index into registry.aiThinks) of the agents due this frame
+	std::vector<std::pair<float, int>> due;
+};
@@ -1,18 +1,89 @@
 // internal
 #include "ai_system.hpp"
 
-void AISystem::step(float elapsed_ms, float width, float height) {
-	stepEnemyHunter(elapsed_ms);
-	stepEnemyBacteria(elapsed_ms, width, height);
-	stepEnemyChase(elapsed_ms);
-	stepEnemySwarm(elapsed_ms);
-	stepEnemyCoord(elapsed_ms, width, height);
-	stepEnemyGerm(elapsed_ms);
-	stepEnemyAStar(elapsed_ms, width, height);
-	stepEnemyBoss(elapsed_ms);
+void AISystem::step(float elapsed_ms, float /*width*/, float /*height*/) {
+	// everything the jobs share is prepared up front and stays fixed while they run
+	lod.update();
+	spatialQuery.build(SPATIAL_CELL_SIZE * defaultResolution.scaling);
+	scheduler.update(elapsed_ms);
+	updatePlayerFlowFields();
+	processPathRequests();
+	takePlayerSnapshot();
+
+	workers.run(ai_job_count, [&](int i) {
+		runJob((AI_JOB)i, elapsed_ms);
+		// resolve the job's steering in one pass while still on the worker
+		jobs[i].steering.evaluate();
+		if (validateSteering) {
+			assert(jobs[i].steering.maxReferenceError() < STEERING_REFERENCE_TOLERANCE);
+		}
+	});
+
+	for (AIJobContext& job : jobs) {
+		job.steering.apply();
+		job.steering.clear();
+		for (const std::function<void()>& deferred : job.deferred) {
+			deferred();
+		}
+		job.deferred.clear();
+	}
+}
+
+void AISystem::takePlayerSnapshot() {
+	players.clear();
+	playersAllAlive = true;
+	for (uint i = 0; i < registry.players.size(); i++) {
+		Entity entity = registry.players.entities[i];
+		bool isDead = registry.players.components[i].isDead;
+		players.push_back({ entity, registry.motions.get(entity).position, isDead });
+		playersAllAlive = playersAllAlive && !isDead;
+	}
+}
+
+void AISystem::runJob(AI_JOB type, float elapsed_ms) {
+	AIJobContext& job = jobs[(int)type];
+	switch (type) {
+	case AI_JOB::HUNTER:
+		stepEnemyHunter(job);
+		break;
+	case AI_JOB::BACTERIA:
+		stepEnemyBacteria(elapsed_ms, job);
+		break;
+	case AI_JOB::CHASE:
+		stepEnemyChase(elapsed_ms, job);
+		break;
+	case AI_JOB::SWARM:
+		stepEnemySwarm(job);
+		break;
+	case AI_JOB::COORD:
+		stepEnemyCoord(job);
+		break;
+	case AI_JOB::GERM:
+		stepEnemyGerm(elapsed_ms, job);
+		break;
+	case AI_JOB::ASTAR:
+		stepEnemyAStar(elapsed_ms, job);
+		break;
+	case AI_JOB::BOSS:
+		stepEnemyBoss(job);
+		break;
+	default:
+		break;
+	}
+}
+
+void AISystem::deferTexture(AIJobContext& job, Entity entity, TEXTURE_ASSET_ID texture) {
+	job.deferred.push_back([entity, texture]() {
+		registry.renderRequests.remove(entity);
+		registry.renderRequests.insert(
+			entity,
+			{ texture,
+				EFFECT_ASSET_ID::ENEMY,
+				GEOMETRY_BUFFER_ID::SPRITE });
+	});
 }
 
-void AISystem::stepEnemyHunter(float elapsed_ms) {
+void AISystem::stepEnemyHunter(AIJobContext& job) {
 	for (Entity hunterEntity : registry.enemyHunters.entities) {
 		EnemyHunter& hunter = registry.enemyHunters.get(hunterEntity);
 		Enemy& hunterStatus = registry.enemies.get(hunterEntity);
@@ -21,639 +92,279 @@ void AISystem::stepEnemyHunter(float elapsed_ms) {
 				hunter.currentState = hunter.fleeingMode;
 			}
 			if (hunter.currentState == hunter.fleeingMode && hunter.isFleeing == false) {
-				registry.motions.get(hunterEntity).velocity = vec2(2.0f * hunterStatus.speed, 0);
+				job.steering.setVelocity(hunterEntity, vec2(2.0f * hunterStatus.speed, 0));
 				hunter.isFleeing = true;
-				registry.renderRequests.remove(hunterEntity);
-				registry.renderRequests.insert(
-					hunterEntity,
-					{ TEXTURE_ASSET_ID::ENEMYHUNTERFLEE,
-						EFFECT_ASSET_ID::ENEMY,
-						GEOMETRY_BUFFER_ID::SPRITE });
+				deferTexture(job, hunterEntity, TEXTURE_ASSET_ID::ENEMYHUNTERFLEE);
 				hunter.isAnimatingHurt = false;
 			}
 			else {
-				if (hunter.timeToUpdateAi) {
+				if (registry.aiThinks.get(hunterEntity).thinkNow) {
 					if (hunter.currentState == hunter.searchingMode) {
 						if (isEnemyInRangeOfThePlayers(hunterEntity)) {
 							hunter.currentState = hunter.huntingMode;
-							registry.renderRequests.remove(hunterEntity);
-							registry.renderRequests.insert(
-								hunterEntity,
-								{ TEXTURE_ASSET_ID::ENEMYHUNTERMAD,
-									EFFECT_ASSET_ID::ENEMY,
-									GEOMETRY_BUFFER_ID::SPRITE });
+							deferTexture(job, hunterEntity, TEXTURE_ASSET_ID::ENEMYHUNTERMAD);
 							hunter.isAnimatingHurt = false;
 						}
 						else {
-							setEnemyWonderingRandomly(hunterEntity);
+							setEnemyWonderingRandomly(hunterEntity, job);
 						}
 					}
 					if (hunter.currentState == hunter.huntingMode) {
-						setEnemyChasingThePlayer(hunterEntity);
-					}
-					hunter.timeToUpdateAi = false;
-					hunter.aiUpdateTimer = hunter.aiUpdateTime;
-				}
-				else {
-					hunter.aiUpdateTimer -= elapsed_ms;
-					if (hunter.aiUpdateTimer < 0) {
-						hunter.timeToUpdateAi = true;
+						setEnemyChasingThePlayer(hunterEntity, job);
 					}
 				}
 			}
-			resolveHunterAnimation(hunterEntity, hunterStatus, hunter);
+			resolveHunterAnimation(hunterEntity, hunterStatus, hunter, job);
 		}
 	}
 }
 
-void AISystem::resolveHunterAnimation(Entity hunterEntity, Enemy& hunterStatus, EnemyHunter& hunter) {
+void AISystem::resolveHunterAnimation(Entity hunterEntity, Enemy& hunterStatus, EnemyHunter& hunter, AIJobContext& job) {
 	if (hunter.isAnimatingHurt && !hunterStatus.isInvin) {
 		if (hunter.currentState == hunter.searchingMode) {
-			registry.renderRequests.remove(hunterEntity);
-			registry.renderRequests.insert(
-				hunterEntity,
-				{ TEXTURE_ASSET_ID::ENEMYHUNTER,
-					EFFECT_ASSET_ID::ENEMY,
-					GEOMETRY_BUFFER_ID::SPRITE });
+			deferTexture(job, hunterEntity, TEXTURE_ASSET_ID::ENEMYHUNTER);
 			hunter.isAnimatingHurt = false;
 		}
 		else if (hunter.currentState == hunter.huntingMode) {
-			registry.renderRequests.remove(hunterEntity);
-			registry.renderRequests.insert(
-				hunterEntity,
-				{ TEXTURE_ASSET_ID::ENEMYHUNTERMAD,
-					EFFECT_ASSET_ID::ENEMY,
-					GEOMETRY_BUFFER_ID::SPRITE });
+			deferTexture(job, hunterEntity, TEXTURE_ASSET_ID::ENEMYHUNTERMAD);
 			hunter.isAnimatingHurt = false;
 		}
 		else {
 			// hunter.fleeingMode
-			registry.renderRequests.remove(hunterEntity);
-			registry.renderRequests.insert(
-				hunterEntity,
-				{ TEXTURE_ASSET_ID::ENEMYHUNTERFLEE,
-					EFFECT_ASSET_ID::ENEMY,
-					GEOMETRY_BUFFER_ID::SPRITE });
+			deferTexture(job, hunterEntity, TEXTURE_ASSET_ID::ENEMYHUNTERFLEE);
 			hunter.isAnimatingHurt = false;
 		}
 	}
 }
 
-enum class BTState {
-	Running,
-	Success,
-	Failure
-};
-
-// The base class representing any node in our behaviour tree
-class BTNode {
-public:
-	virtual void init(Entity e) {};
-	virtual BTState process(Entity e) = 0;
-};
-
-// A composite node that loops through all children and exits when one fails
-class BTRunPair : public BTNode {
-private:
-	int m_index;
-	BTNode* m_children[2];
-
-public:
-	BTRunPair(BTNode* c0, BTNode* c1)
-		: m_index(0) {
-		m_children[0] = c0;
-		m_children[1] = c1;
-	}
-
-	void init(Entity e) override
-	{
-		m_index = 0;
-		// initialize the first child
-		const auto& child = m_children[m_index];
-		child->init(e);
-	}
-
-	BTState process(Entity e) override {
-		if (m_index >= 2)
-			return BTState::Success;
-
-		// process current child
-		BTState state = m_children[m_index]->process(e);
-
-		// select a new active child and initialize its internal state
-		if (state == BTState::Success) {
-			++m_index;
-			if (m_index >= 2) {
-				return BTState::Success;
-			}
-			else {
-				m_children[m_index]->init(e);
-				return BTState::Running;
-			}
-		}
-		else {
-			return state;
-		}
-	}
-};
+// Germ behaviour tree leaves and conditions, the tree itself is built once in buildGermBehaviourTree
+static bool germPlayersAllAlive(Entity /*e*/, const BTBlackboard& blackboard) {
+	return blackboard.playersAllAlive;
+}
 
-// A general decorator with lambda condition
-// TAKES IN BTNode and CONDITION.
-// If condition passes, it will run the child process. If not, finish by returning "success" and do not run child process.
-class BTIfCondition : public BTNode
-{
-public:
-	BTIfCondition(BTNode* child, std::function<bool(Entity)> condition)
-		: m_child(child), m_condition(condition) {
-	}
+static bool germPlayerDown(Entity /*e*/, const BTBlackboard& blackboard) {
+	return !blackboard.playersAllAlive;
+}
 
-	virtual void init(Entity e) override {
-		m_child->init(e);
-	}
+static BT_STATE germChasePlayer(Entity /*e*/, BTBlackboard& blackboard) {
+	blackboard.seeksTarget = true;
+	return BT_STATE::SUCCESS;
+}
 
-	virtual BTState process(Entity e) override {
-		if (m_condition(e))
-			return m_child->process(e);
-		else
-			return BTState::Success;
+static BT_STATE germExplode(Entity e, BTBlackboard& blackboard) {
+	EnemyGerm& germ = registry.enemyGerms.get(e);
+	if (germ.explosionCountDown == 0) {
+		germ.explosionCountDown = germ.explosionCountInit;
+		// randomized numbers for randomized velocity multiplier
+		float randomizedSpeedX = blackboard.explosionRoll.x;
+		float randomizedSpeedY = blackboard.explosionRoll.y;
+		float speed = registry.enemies.get(e).speed;
+		blackboard.velocity = vec2(speed * randomizedSpeedX, speed * randomizedSpeedY);
+		blackboard.hasVelocity = true;
 	}
-
-private:
-	BTNode* m_child;
-	std::function<bool(Entity)> m_condition;
-};
-
-
-// LEAF NODE - has a prrocess that will be run if this node is met
-class ChasePlayer : public BTNode {
-private:
-	void init(Entity e) override {
+	else {
+		germ.explosionCountDown--;
 	}
+	return BT_STATE::SUCCESS;
+}
 
-	BTState process(Entity e) override {
-		// modify world
-		float finX = registry.motions.get(registry.players.entities[0]).position.x;
-		float finY = registry.motions.get(registry.players.entities[0]).position.y;
-		if (registry.players.entities.size() > 1 && registry.enemyGerms.get(e).mode <= registry.enemyGerms.get(e).playerChaseThreshold) {
-			finX = registry.motions.get(registry.players.entities[1]).position.x;
-			finY = registry.motions.get(registry.players.entities[1]).position.y;
-		}
-		float initX = registry.motions.get(e).position.x;
-		float initY = registry.motions.get(e).position.y;
+// Chase while every player is alive, explode once one of them is down
+void AISystem::buildGermBehaviourTree() {
+	germTree.beginSequence();
+		germTree.beginIfCondition(germPlayersAllAlive);
+			germTree.action(germChasePlayer);
+		germTree.end();
+		germTree.beginIfCondition(germPlayerDown);
+			germTree.action(germExplode);
+		germTree.end();
+	germTree.end();
+}
 
-		vec2 diff = vec2(finX, finY) - vec2(initX, initY);
-		float angle = atan2(diff.y, diff.x);
-		registry.motions.get(e).velocity = vec2(cos(angle) * registry.enemies.get(e).speed, sin(angle) * registry.enemies.get(e).speed);
-		// return progress
-		return BTState::Success;
+void AISystem::stepEnemyGerm(float elapsed_ms, AIJobContext& job) {
+	if (players.size() == 0) {
+		return;
 	}
-};
 
-// LEAF NODE - has a prrocess that will be run if this node is met
-class Explode : public BTNode {
-private:
-	void init(Entity e) override {
-	}
-	BTState process(Entity e) override {
-		// modify world
-		if (registry.enemyGerms.get(e).explosionCountDown == 0) {
-			registry.enemyGerms.get(e).explosionCountDown = registry.enemyGerms.get(e).explosionCountInit;
-			float randomizedSpeedX = (rand() % 6) - 5; // randomized number for randomized velocity multiplier
-			float randomizedSpeedY = (rand() % 6) - 5; // randomized number for randomized velocity multiplier
-			if (registry.enemyGerms.get(e).mode <= registry.enemyGerms.get(e).playerChaseThreshold) {
-				registry.motions.get(e).velocity.y = registry.enemies.get(e).speed * randomizedSpeedY;
-				registry.motions.get(e).velocity.x = registry.enemies.get(e).speed * randomizedSpeedX;
-			}
-			else {
-				registry.motions.get(e).velocity.x = registry.enemies.get(e).speed * randomizedSpeedX;
-				registry.motions.get(e).velocity.y = registry.enemies.get(e).speed * randomizedSpeedY;
-			}
-		}
-		else {
-			registry.enemyGerms.get(e).explosionCountDown--;
-		}
-		// return progress
-		return BTState::Success;
-	}
-};
-
-
-void AISystem::stepEnemyGerm(float elapsed_ms) {
-	for (Entity germEntity : registry.enemyGerms.entities) {
-		EnemyGerm& germ = registry.enemyGerms.get(germEntity);
-		germ.next_germ_behaviour_calculation -= elapsed_ms;
+	for (uint i = 0; i < registry.enemyGerms.size(); i++) {
+		EnemyGerm& germ = registry.enemyGerms.components[i];
+		Entity germEntity = registry.enemyGerms.entities[i];
+		germ.next_germ_behaviour_calculation -= aiLodElapsed(getAILodTier(germEntity), elapsed_ms);
 		if (germ.next_germ_behaviour_calculation < 0.f) {
 			germ.next_germ_behaviour_calculation = germ.germBehaviourUpdateTime;
 
-			// BTNode (leaf node, a process that will be run if reached)
-			ChasePlayer chasePlayer;
-
-			// creating condition for chasing player, if player(s) is/are alive
-			std::function<bool(Entity)> conditionChasePlayer = [](Entity e)
-			{
-				if (registry.players.entities.size() > 1) {
-					return !registry.players.get(registry.players.entities[0]).isDead && !registry.players.get(registry.players.entities[1]).isDead;
-				}
-				else {
-					return !registry.players.get(registry.players.entities[0]).isDead;
-				}
-			};
-
-			// BTNode (node that is a condition, and if condition is met, will run the child node that is passed in)
-			BTIfCondition chase = BTIfCondition(&chasePlayer, conditionChasePlayer);
-			// BTNode (leaf node, a process that will be run if reached)
-			Explode explode;
-
-			// creating condition for exploding, if one player has died
-			std::function<bool(Entity)> conditionExplosion = [](Entity e)
-			{
-				if (registry.players.entities.size() > 1) {
-					return registry.players.get(registry.players.entities[0]).isDead || registry.players.get(registry.players.entities[1]).isDead;
-				}
-				else {
-					return registry.players.get(registry.players.entities[0]).isDead;
-				}
-			};
-
-			// BTNode (node that is a condition, and if condition is met, will run the child node that is passed in)
-			BTIfCondition explosion = BTIfCondition(&explode, conditionExplosion);
-
-			// run the two BTNodes 
-			BTRunPair root = BTRunPair(&chase, &explosion);
-			root.init(germEntity);
-
-			// iterate through all the different steps
-			for (int i = 0; i < 2; i++) {
-				// run processes (0 to 1 because there is 2 steps (BTIFCondition for chase and for explode)
-				BTState state = root.process(germEntity);
-				if (state != BTState::Running) {
-					break;
-				}
+			BTBlackboard& blackboard = registry.btBlackboards.get(germEntity);
+			blackboard.playersAllAlive = playersAllAlive;
+			const AIPlayerSnapshot& target = players.size() > 1 && germ.mode <= germ.playerChaseThreshold ? players[1] : players[0];
+			blackboard.targetPosition = target.position;
+			blackboard.explosionRoll = ivec2(gameRandomInt(germEntity, RANDOM_PURPOSE::GERM_EXPLOSION, -5, 0, 0),
+				gameRandomInt(germEntity, RANDOM_PURPOSE::GERM_EXPLOSION, -5, 0, 1));
+			blackboard.hasVelocity = false;
+			blackboard.seeksTarget = false;
+			germTree.tick(germEntity, blackboard);
+			if (blackboard.seeksTarget) {
+				job.steering.seek(germEntity, registry.motions.get(germEntity).position, blackboard.targetPosition, registry.enemies.get(germEntity).speed);
+			}
+			else if (blackboard.hasVelocity) {
+				job.steering.setVelocity(germEntity, blackboard.velocity);
 			}
 		}
 	}
 }
 
-// separate map into an 8x8 "grid"
-void AISystem::createAdj() {
-	for (int i = 0; i < 8; i++) {
-		for (int j = 0; j < 8; j++) {
-			visited[i][j] = false;
-			pred[i][j] = { -1, -1 };
-			adj[i][j] = { i, j };
-		}
-	}
-	blocksInitialized = true;
-}
-
-void AISystem::stepEnemyBacteria(float elapsed_ms, float width, float height) {
+void AISystem::stepEnemyBacteria(float elapsed_ms, AIJobContext& job) {
 	for (Entity bacteriaEntity : registry.enemyBacterias.entities) {
-		Enemy& enemy = registry.enemies.get(bacteriaEntity);
-		if (!enemy.isDead) {
-			registry.enemyBacterias.get(bacteriaEntity).next_bacteria_BFS_calculation -= elapsed_ms;
-			registry.enemyBacterias.get(bacteriaEntity).next_bacteria_PATH_calculation -= elapsed_ms;
-			auto& motions_registry = registry.motions;
-			if (registry.enemyBacterias.get(bacteriaEntity).next_bacteria_BFS_calculation < 0.f) {
-				EnemyBacteria& bacteria = registry.enemyBacterias.get(bacteriaEntity);
-				Motion& player1Motion = motions_registry.get(registry.players.entities[0]);
-
-				// if bacteria is hunting, it will do BFS to find player
-				if (bacteria.huntingMode) {
-					bacteria.huntingMode = false;
-
-					createAdj();
-
-					// twoPlayerMode ? select random player to follow
-					if (twoPlayer.inTwoPlayerMode) {
-						registry.enemyBacterias.get(bacteriaEntity).next_bacteria_BFS_calculation = bacteria.bfsUpdateTime;
-						Motion player2Motion = motions_registry.get(registry.players.entities[1]);
-						float pickPlayer = rand() % 2 + 1;
-
-						if (pickPlayer != 1 && !registry.players.get(registry.players.entities[1]).isDead) {
-							registry.enemyBacterias.get(bacteriaEntity).finX = player2Motion.position.x;
-							registry.enemyBacterias.get(bacteriaEntity).finY = player2Motion.position.y;
-
-							handlePath(width, height, bacteriaEntity);
-						}
-						else {
-							registry.enemyBacterias.get(bacteriaEntity).finX = player1Motion.position.x;
-							registry.enemyBacterias.get(bacteriaEntity).finY = player1Motion.position.y;
-
-							handlePath(width, height, bacteriaEntity);
-						}
+		AI_LOD_TIER tier = getAILodTier(bacteriaEntity);
+		if (tier != AI_LOD_TIER::FROZEN) {
+			EnemyBacteria& bacteria = registry.enemyBacterias.get(bacteriaEntity);
+			bacteria.next_target_calculation -= aiLodElapsed(tier, elapsed_ms);
+
+			// twoPlayerMode ? select random player to follow
+			bool retarget = bacteria.next_target_calculation < 0.f;
+			if (retarget) {
+				bacteria.next_target_calculation = bacteria.targetUpdateTime;
+				bacteria.targetPlayer = 0;
+				if (twoPlayer.inTwoPlayerMode && players.size() > 1) {
+					if (gameRandom(bacteriaEntity, RANDOM_PURPOSE::TARGET_PLAYER) > 0.5f && !players[1].isDead) {
+						bacteria.targetPlayer = 1;
 					}
-					else {
-						registry.enemyBacterias.get(bacteriaEntity).next_bacteria_BFS_calculation = bacteria.bfsUpdateTime;
-						registry.enemyBacterias.get(bacteriaEntity).finX = player1Motion.position.x;
-						registry.enemyBacterias.get(bacteriaEntity).finY = player1Motion.position.y;
+				}
+			}
 
-						handlePath(width, height, bacteriaEntity);
-					}
+			// large arenas have no flow fields, the bacteria walks a hierarchical path that is refreshed on every retarget
+			if (hasNavGrid() && useHierarchicalSearch(getNavGrid())) {
+				// a path cut short at the buffer capacity is planned again from where it ended
+				bool replan = retarget || (bacteria.waypoints.empty() && bacteria.waypoints.truncated);
+				if (replan && bacteria.targetPlayer < (int)players.size()) {
+					vec2 start = registry.motions.get(bacteriaEntity).position;
+					vec2 goal = players[bacteria.targetPlayer].position;
+					job.deferred.push_back([this, bacteriaEntity, start, goal]() {
+						pathRequests.request(bacteriaEntity, start, goal);
+					});
 				}
+				followBacteriaPath(bacteriaEntity, bacteria, job);
 			}
-		}
-	}
-	for (Entity bacteriaEntity : registry.enemyBacterias.entities) {
-		Enemy& enemy = registry.enemies.get(bacteriaEntity);
-		if (!enemy.isDead) {
-			if (registry.enemyBacterias.get(bacteriaEntity).next_bacteria_PATH_calculation < 0.f) {
-				EnemyBacteria& bacteria = registry.enemyBacterias.get(bacteriaEntity);
-				registry.enemyBacterias.get(bacteriaEntity).next_bacteria_PATH_calculation = bacteria.pathUpdateTime;
-				findPath(bacteriaEntity);
+			else {
+				// the player's flow field already holds the BFS result, so following it costs one lookup
+				followFlowField(bacteriaEntity, bacteria.targetPlayer, job);
 			}
 		}
 	}
-
 }
 
-void AISystem::stepEnemyChase(float elapsed_ms) {
+void AISystem::stepEnemyChase(float elapsed_ms, AIJobContext& job) {
 	// update enemy chase so it chases the player
 	for (Entity entity : registry.enemyChase.entities) {
 		EnemyChase& chase = registry.enemyChase.get(entity);
 		Enemy& enemy = registry.enemies.get(entity);
-		if (chase.timeToUpdateAi && !enemy.isDead) {
+		if (registry.aiThinks.get(entity).thinkNow && !enemy.isDead) {
 			auto& enemyCom = registry.enemies.get(entity);
 			Motion& motion = registry.motions.get(entity);
-			Entity playerEntity = pickAPlayer();
-			Motion& playerMotion = registry.motions.get(playerEntity);
+			vec2 playerPosition = pickAPlayer(entity).position;
 
 			// check if it is close to any other enemyChase
 			// if yes, make it move in opposite direction for a certain time
-			for (Entity other_enemy_chase : registry.enemyChase.entities) {
+			spatialQuery.queryRadius(motion.position, sqrt((float)chase.enemy_chase_max_dist_sq), &registry.enemyChase, job.neighbours);
+			for (Entity other_enemy_chase : job.neighbours) {
 				if (other_enemy_chase != entity) {
-					Motion& motion_other_en_chase = registry.motions.get(other_enemy_chase);
-					vec2 dp = motion_other_en_chase.position - motion.position;
-					float dist_squared = dot(dp, dp);
-					if (dist_squared < registry.enemyChase.get(entity).enemy_chase_max_dist_sq) {
-						// set encounter to true
-						registry.enemyChase.get(entity).encounter = 1;
-						motion.velocity = vec2{ dp.x * -1.f, dp.y * -1.f };
-					}
-					if (registry.enemyChase.get(entity).encounter == 1) {
-						registry.enemyChase.get(entity).counter_ms -= elapsed_ms;
-						if (registry.enemyChase.get(entity).counter_ms < 0) {
-							vec2 chase_to_wz = vec2(playerMotion.position.x - motion.position.x, playerMotion.position.y - motion.position.y);
-							float radians_for_angle = atan2f(-chase_to_wz.y, -chase_to_wz.x);
-							float radians = atan2f(chase_to_wz.y, chase_to_wz.x);
-							motion.angle = radians_for_angle;
-							motion.velocity = vec2(enemyCom.speed * cos(-radians), enemyCom.speed * sin(radians));
-							registry.enemyChase.get(entity).encounter == 0;
-							registry.enemyChase.get(entity).counter_other_en_chase_ms = registry.enemyChase.get(entity).counter_other_en_chase_value;
-						}
-					}
-				}
-				else {
-					registry.enemyChase.get(entity).counter_ms -= elapsed_ms;
-					// reset timer and encounter variable when timer expires and
-					// recalculate direction turtle is facing
-					if (registry.enemyChase.get(entity).counter_ms < 0) {
-						registry.enemyChase.get(entity).counter_ms = registry.enemyChase.get(entity).counter_value;
-						vec2 chase_to_wz = vec2(playerMotion.position.x - motion.position.x, playerMotion.position.y - motion.position.y);
-						float radians_for_angle = atan2f(-chase_to_wz.y, -chase_to_wz.x);
-						float radians = atan2f(chase_to_wz.y, chase_to_wz.x);
-						motion.angle = radians_for_angle;
-						motion.velocity = vec2(enemyCom.speed * cos(-radians), enemyCom.speed * sin(radians));
-					}
+					vec2 dp = registry.motions.get(other_enemy_chase).position - motion.position;
+					// set encounter to true
+					chase.encounter = 1;
+					job.steering.setVelocity(entity, vec2{ dp.x * -1.f, dp.y * -1.f });
 				}
-				chase.timeToUpdateAi = false;
-				chase.aiUpdateTimer = chase.aiUpdateTime;
-			}
-		}
-		else {
-			chase.aiUpdateTimer -= elapsed_ms;
-			if (chase.aiUpdateTimer < 0) {
-				chase.timeToUpdateAi = true;
 			}
-		}
-	}
-}
-
-bool AISystem::handlePath(float width, float height, Entity& bacteriaEntity) {
-	int positionX = registry.enemyBacterias.get(bacteriaEntity).finX;
-	int positionY = registry.enemyBacterias.get(bacteriaEntity).finY;
-	Motion playerMotion = registry.motions.get(registry.players.entities[0]);
-	Motion bacteriaMotion = registry.motions.get(bacteriaEntity);
-
-	// bacteria initial position (with respect to 8x8 grid)
-	int resIndexX = bacteriaMotion.position.x / (width / 8);
-	int resIndexY = bacteriaMotion.position.y / (height / 8);
 
-	// final position (player position, with respect to 8x8 grid)
-	int finXPosition = positionX / (width / 8);
-	int finYPosition = positionY / (height / 8);
-
-	// initialize first position, it will be visited later, add it to the queue
-	visited[resIndexX][resIndexY] = false;
-	registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.push({ resIndexX, resIndexY });
-	std::pair<int, int> currPosition = registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.front();
-
-	while (!registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.empty()) {
-		// get first element in queue
-		currPosition = registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.front();
-		registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.pop();
-
-		// check if it's out of bounds or has been visited. if so, skip
-		if (currPosition.first < 8 && currPosition.second < 8 && visited[currPosition.first][currPosition.second] == false && currPosition.first >= 0 && currPosition.second >= 0) {
-
-			// visited
-			visited[currPosition.first][currPosition.second] = true;
-
-
-			// We stop BFS when we find destination.
-			if (currPosition.first == finXPosition && currPosition.second == finYPosition) {
-				bfsSearchPath(resIndexX, resIndexY, finXPosition, finYPosition, bacteriaEntity, width, height);
-				registry.enemyBacterias.get(bacteriaEntity).huntingMode = true;
-				return true;
-			}
-
-			// add adjacent "grid" block above to queue
-			if (currPosition.second - 1 >= 0) {
-				if (visited[currPosition.first][currPosition.second - 1] == false) {
-					registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.push({ currPosition.first, currPosition.second - 1 });
-				}
-				if (pred[currPosition.first][currPosition.second - 1].first == -1 && pred[currPosition.first][currPosition.second - 1].second == -1) {
-					pred[currPosition.first][currPosition.second - 1] = { currPosition.first, currPosition.second };
-				}
-			}
-
-			// add adjacent "grid" block below to queue
-			if (currPosition.second + 1 < 8) {
-				if (visited[currPosition.first][currPosition.second + 1] == false) {
-					registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.push({ currPosition.first, currPosition.second + 1 });
-				}
-				if (pred[currPosition.first][currPosition.second + 1].first == -1 && pred[currPosition.first][currPosition.second + 1].second == -1) {
-					pred[currPosition.first][currPosition.second + 1] = { currPosition.first, currPosition.second };
-				}
-			}
-
-			// add adjacent "grid" block left to queue
-			if (currPosition.first - 1 >= 0) {
-				if (visited[currPosition.first - 1][currPosition.second] == false) {
-					registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.push({ currPosition.first - 1, currPosition.second });
-				}
-				if (pred[currPosition.first - 1][currPosition.second].first == -1 && pred[currPosition.first - 1][currPosition.second].second == -1) {
-					pred[currPosition.first - 1][currPosition.second] = { currPosition.first, currPosition.second };
-				}
-			}
-
-			// add adjacent "grid" block right to queue
-			if (currPosition.first + 1 < 8) {
-				if (visited[currPosition.first + 1][currPosition.second] == false) {
-					registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.push({ currPosition.first + 1, currPosition.second });
-				}
-				if (pred[currPosition.first + 1][currPosition.second].first == -1 && pred[currPosition.first + 1][currPosition.second].second == -1) {
-					pred[currPosition.first + 1][currPosition.second] = { currPosition.first, currPosition.second };
-				}
+			chase.counter_ms -= elapsed_ms;
+			// reset timer and encounter variable when timer expires and
+			// recalculate direction turtle is facing
+			if (chase.counter_ms < 0) {
+				chase.counter_ms = chase.counter_value;
+				chase.encounter = 0;
+				vec2 chase_to_wz = vec2(playerPosition.x - motion.position.x, playerPosition.y - motion.position.y);
+				// the sprite needs an angle, the velocity comes from the batch without trig
+				motion.angle = atan2f(-chase_to_wz.y, -chase_to_wz.x);
+				job.steering.seek(entity, motion.position, playerPosition, enemyCom.speed);
 			}
 		}
-
 	}
-	return false;
-
 }
 
-void AISystem::findPath(Entity& bacteriaEntity) {
-	float finX = registry.enemyBacterias.get(bacteriaEntity).finX;
-	float finY = registry.enemyBacterias.get(bacteriaEntity).finY;
-	std::pair<int, int> currPosition = { finX , finY };
-	// go through traversal stack. it should have the path now.
-	// if it's empty, don't do anything.
-	if (!registry.enemyBacterias.get(bacteriaEntity).traversalStack.empty()) {
-		// get current position of traversal stack
-		currPosition = registry.enemyBacterias.get(bacteriaEntity).traversalStack.top();
-		registry.enemyBacterias.get(bacteriaEntity).traversalStack.pop();
-		int bacteriaPositionX = registry.motions.get(bacteriaEntity).position.x;
-		int bacteriaPositionY = registry.motions.get(bacteriaEntity).position.y;
-
-		// from the current bacteria position, go to 
-		moveToSpot(bacteriaPositionX, bacteriaPositionY, currPosition.first, currPosition.second, bacteriaEntity);
+void AISystem::updatePlayerFlowFields() {
+	// a whole-grid field per player move is what large arenas cannot afford, they path hierarchically
+	if (!hasNavGrid() || useHierarchicalSearch(getNavGrid())) {
+		playerFlowFields.clear();
+		return;
+	}
+	const NavGrid& grid = getNavGrid();
+	playerFlowFields.resize(registry.players.size());
+	for (uint i = 0; i < registry.players.size(); i++) {
+		updateFlowField(playerFlowFields[i], grid, registry.motions.get(registry.players.entities[i]).position);
 	}
 }
 
-void AISystem::bfsSearchPath(float initX, float initY, float finX, float finY, Entity& bacteriaEntity, float width, float height) {
-	std::pair<int, int> currPosition = { finX , finY };
-
-	// traverse from the final destination "grid" block
-	// turn it back into the actually screen size using * (width/8) or * (height/8)
-	// push into our traversalStack -- stack because we are now going BACKWARDS from the end to the beginning, using the predecessor to find our path from the player to the bacteria.
-	while (currPosition.first != initX || currPosition.second != initY) {
-		std::pair<int, int> temp = { pred[currPosition.first][currPosition.second].first * (width / 8),  pred[currPosition.first][currPosition.second].second * (height / 8) };
-		registry.enemyBacterias.get(bacteriaEntity).traversalStack.push(temp);
-		currPosition = pred[currPosition.first][currPosition.second];
+void AISystem::followFlowField(Entity enemyEntity, int playerIndex, AIJobContext& job) {
+	if (!hasNavGrid() || playerIndex >= (int)playerFlowFields.size()) {
+		return;
 	}
-
-	while (!registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.empty())
-	{
-		registry.enemyBacterias.get(bacteriaEntity).adjacentsQueue.pop();
+	Motion& motion = registry.motions.get(enemyEntity);
+	vec2 direction = sampleFlowField(playerFlowFields[playerIndex], getNavGrid(), motion.position);
+	// in the player's cell, or cut off from it, head straight for the player
+	if (direction == vec2(0, 0)) {
+		vec2 toPlayer = players[playerIndex].position - motion.position;
+		if (dot(toPlayer, toPlayer) > 0.f) {
+			direction = normalize(toPlayer);
+		}
 	}
+	job.steering.setVelocity(enemyEntity, direction * registry.enemies.get(enemyEntity).speed);
 }
 
-void AISystem::moveToSpot(float initX, float initY, float finalX, float finalY, Entity& bacteriaEntity) {
-	vec2 diff = vec2(finalX, finalY) - vec2(initX, initY);
-	float angle = atan2(diff.y, diff.x);
-	registry.motions.get(bacteriaEntity).velocity = vec2(cos(angle) * registry.enemies.get(bacteriaEntity).speed, sin(angle) * registry.enemies.get(bacteriaEntity).speed);
+void AISystem::moveToSpot(float initX, float initY, float finalX, float finalY, Entity& bacteriaEntity, AIJobContext& job) {
+	job.steering.seek(bacteriaEntity, vec2(initX, initY), vec2(finalX, finalY), registry.enemies.get(bacteriaEntity).speed);
 }
 
 bool AISystem::isEnemyInRangeOfThePlayers(Entity enemyEntity) {
-	Motion& enemyMotion = registry.motions.get(enemyEntity);
-	float distance;
-	if (twoPlayer.inTwoPlayerMode) {
-		Motion& player1Motion = registry.motions.get(registry.players.entities.front());
-		Motion& player2Motion = registry.motions.get(registry.players.entities.back());
-		float distFromPlayer1 = enemyDistanceFromPlayer(player1Motion, enemyMotion);
-		float distFromPlayer2 = enemyDistanceFromPlayer(player2Motion, enemyMotion);
-		distance = std::min(distFromPlayer1, distFromPlayer2);
-	}
-	else {
-		Motion& player1Motion = registry.motions.get(registry.players.entities.front());
-		distance = enemyDistanceFromPlayer(player1Motion, enemyMotion);
-	}
-	if (distance < registry.enemyHunters.get(enemyEntity).huntingRange) {
-		return true;
-	}
-	return false;
+	Entity player = enemyEntity;
+	float huntingRange = registry.enemyHunters.get(enemyEntity).huntingRange;
+	return spatialQuery.findNearest(registry.motions.get(enemyEntity).position, huntingRange, &registry.players, enemyEntity, player);
 }
 
-float AISystem::enemyDistanceFromPlayer(const Motion& player, const Motion& hunter) {
-	vec2 dp = player.position - hunter.position;
-	return sqrt(dot(dp, dp));
-}
-
-void AISystem::setEnemyWonderingRandomly(Entity enemyEntity) {
+void AISystem::setEnemyWonderingRandomly(Entity enemyEntity, AIJobContext& job) {
 	Enemy& enemyStatus = registry.enemies.get(enemyEntity);
-	float randomNumBetweenNegativeOneAndOne = (uniform_dist(rng) - 0.5) * 2;
-	float anotherRandomNumBetweenNegativeOneAndOne = (uniform_dist(rng) - 0.5) * 2;
-	vec2 randomVelocity =
-		vec2(1.0f * enemyStatus.speed * randomNumBetweenNegativeOneAndOne,
-			1.0f * enemyStatus.speed * anotherRandomNumBetweenNegativeOneAndOne);
-	registry.motions.get(enemyEntity).velocity = randomVelocity;
+	float randomNumBetweenNegativeOneAndOne = (gameRandom(enemyEntity, RANDOM_PURPOSE::WANDER, 0) - 0.5) * 2;
+	float anotherRandomNumBetweenNegativeOneAndOne = (gameRandom(enemyEntity, RANDOM_PURPOSE::WANDER, 1) - 0.5) * 2;
+	job.steering.wander(enemyEntity, vec2(randomNumBetweenNegativeOneAndOne, anotherRandomNumBetweenNegativeOneAndOne), enemyStatus.speed);
 }
 
-void AISystem::setEnemyChasingThePlayer(Entity enemyEntity) {
+void AISystem::setEnemyChasingThePlayer(Entity enemyEntity, AIJobContext& job) {
 	Enemy& enemyStatus = registry.enemies.get(enemyEntity);
 	Motion& enemyMotion = registry.motions.get(enemyEntity);
-	Entity playerToChase;
-	if (twoPlayer.inTwoPlayerMode) {
-		playerToChase = determineWhichPlayerToChase(enemyEntity);
-	}
-	else {
-		playerToChase = registry.players.entities.front();
-	}
-	Motion& playerMotion = registry.motions.get(playerToChase);
-	vec2 diff = playerMotion.position - enemyMotion.position;
-	float angle = atan2(diff.y, diff.x);
-	enemyMotion.velocity = vec2(cos(angle) * enemyStatus.speed, sin(angle) * enemyStatus.speed);
+	const AIPlayerSnapshot& playerToChase = determineWhichPlayerToChase(enemyEntity);
+	job.steering.seek(enemyEntity, enemyMotion.position, playerToChase.position, enemyStatus.speed);
 }
 
-Entity AISystem::determineWhichPlayerToChase(Entity enemyEntity) {
-	Motion& enemyMotion = registry.motions.get(enemyEntity);
-	Motion& player1Motion = registry.motions.get(registry.players.entities.front());
-	Motion& player2Motion = registry.motions.get(registry.players.entities.back());
-	float distFromPlayer1 = enemyDistanceFromPlayer(player1Motion, enemyMotion);
-	float distFromPlayer2 = enemyDistanceFromPlayer(player2Motion, enemyMotion);
-	if (distFromPlayer1 < distFromPlayer2) {
-		return registry.players.entities.front();
-	}
-	else {
-		return registry.players.entities.back();
-	}
+const AIPlayerSnapshot& AISystem::determineWhichPlayerToChase(Entity enemyEntity) {
+	Entity playerToChase = players.front().entity;
+	spatialQuery.findNearest(registry.motions.get(enemyEntity).position, std::numeric_limits<float>::max(), &registry.players, enemyEntity, playerToChase);
+	return players.back().entity == playerToChase ? players.back() : players.front();
 }
 
-void AISystem::stepEnemySwarm(float elapsed_ms) {
+void AISystem::stepEnemySwarm(AIJobContext& job) {
 	for (Entity swarmEntity : registry.enemySwarms.entities) {
 		EnemySwarm& swarm = registry.enemySwarms.get(swarmEntity);
 		Enemy& swarmStatus = registry.enemies.get(swarmEntity);
 		if (!swarmStatus.isDead) {
-			if (swarm.timeToUpdateAi) {
+			if (registry.aiThinks.get(swarmEntity).thinkNow) {
 				if (bossMode.currentBossLevel != STAGE2) {
-					swarmSpreadOut(swarmEntity);
-				}
-				swarmFireProjectileAtPlayer(swarmEntity);
-				swarm.timeToUpdateAi = false;
-				swarm.aiUpdateTimer = 0;
-			}
-			else {
-				swarm.aiUpdateTimer += elapsed_ms;
-				if (swarm.aiUpdateTimer > swarm.aiUpdateTime) {
-					swarm.timeToUpdateAi = true;
+					swarmSpreadOut(swarmEntity, job);
 				}
+				swarmFireProjectileAtPlayer(swarmEntity, job);
 			}
 
 			if (swarm.isAnimatingHurt && !swarmStatus.isInvin) {
-				registry.renderRequests.remove(swarmEntity);
 				if (bossMode.currentBossLevel == STAGE1) {
-					registry.renderRequests.insert(
-						swarmEntity,
-						{ TEXTURE_ASSET_ID::MINION,
-							EFFECT_ASSET_ID::ENEMY,
-							GEOMETRY_BUFFER_ID::SPRITE });
+					deferTexture(job, swarmEntity, TEXTURE_ASSET_ID::MINION);
 				}
 				else {
-					registry.renderRequests.insert(
-						swarmEntity,
-						{ TEXTURE_ASSET_ID::ENEMYSWARM,
-							EFFECT_ASSET_ID::ENEMY,
-							GEOMETRY_BUFFER_ID::SPRITE });
+					deferTexture(job, swarmEntity, TEXTURE_ASSET_ID::ENEMYSWARM);
 				}
 				swarm.isAnimatingHurt = false;
 			}
@@ -661,381 +372,259 @@ void AISystem::stepEnemySwarm(float elapsed_ms) {
 	}
 }
 
-void AISystem::swarmSpreadOut(Entity swarmEntity) {
-	if (registry.enemySwarms.entities.size() == 1) {
-		setEnemyWonderingRandomly(swarmEntity);
+void AISystem::swarmSpreadOut(Entity swarmEntity, AIJobContext& job) {
+	Entity closestSwarmEntity = swarmEntity;
+	if (spatialQuery.findNearest(registry.motions.get(swarmEntity).position, std::numeric_limits<float>::max(), &registry.enemySwarms, swarmEntity, closestSwarmEntity)) {
+		moveAwayfromOtherSwarm(swarmEntity, closestSwarmEntity, job);
+	}
+	else {
+		setEnemyWonderingRandomly(swarmEntity, job);
 	}
-	Entity closestSwarmEntity = findClosestSwarm(swarmEntity);
-	moveAwayfromOtherSwarm(swarmEntity, closestSwarmEntity);
 }
 
 
-void AISystem::moveAwayfromOtherSwarm(Entity enemyEntity, Entity otherEnemyEntity) {
+void AISystem::moveAwayfromOtherSwarm(Entity enemyEntity, Entity otherEnemyEntity, AIJobContext& job) {
 	if (registry.motions.has(otherEnemyEntity)) {
 		Motion& enemyMotion = registry.motions.get(enemyEntity);
 		Motion& otherEnemyMotion = registry.motions.get(otherEnemyEntity);
 		EnemySwarm& enemySwarm = registry.enemySwarms.get(enemyEntity);
-		float distance = sqrt(pow(enemyMotion.position.x - otherEnemyMotion.position.x, 2) +
-			pow(enemyMotion.position.y - otherEnemyMotion.position.y, 2));
-		if (distance < enemySwarm.spreadOutDistance) {
-			vec2 directionFromEnemyToOtherEnemy =
-				vec2(otherEnemyMotion.position.x - enemyMotion.position.x, otherEnemyMotion.position.y - enemyMotion.position.y);
-			vec2 oppositeOfDirection = vec2(directionFromEnemyToOtherEnemy.x * -1.f, directionFromEnemyToOtherEnemy.y * -1.f);
-			vec2 normalizedDirection = vec2(oppositeOfDirection.x / sqrt(pow(oppositeOfDirection.x, 2) + pow(oppositeOfDirection.y, 2)),
-				oppositeOfDirection.y / sqrt(pow(oppositeOfDirection.x, 2) + pow(oppositeOfDirection.y, 2)));
+		vec2 directionFromEnemyToOtherEnemy = otherEnemyMotion.position - enemyMotion.position;
+		float distanceSq = dot(directionFromEnemyToOtherEnemy, directionFromEnemyToOtherEnemy);
+		// two swarms stacked on the same spot have no direction to separate along, wandering splits them
+		if (distanceSq > 0.f && distanceSq < enemySwarm.spreadOutDistance * enemySwarm.spreadOutDistance) {
 			Enemy& enemyStatus = registry.enemies.get(enemyEntity);
-			enemyMotion.velocity = vec2(normalizedDirection.x * enemyStatus.speed, normalizedDirection.y * enemyStatus.speed);
+			job.steering.separate(enemyEntity, enemyMotion.position, otherEnemyMotion.position, enemyStatus.speed);
 		}
 		else {
-			setEnemyWonderingRandomly(enemyEntity);
+			setEnemyWonderingRandomly(enemyEntity, job);
 		}
 	}
 	else {
-		setEnemyWonderingRandomly(enemyEntity);
+		setEnemyWonderingRandomly(enemyEntity, job);
 	}
 }
 
-Entity AISystem::findClosestSwarm(Entity swarmEntity) {
-	Motion& swarmMotion = registry.motions.get(swarmEntity);
-	float shortestDistance = std::numeric_limits<float>::max();
-	Entity closestSwarmEntity;
-	for (Entity otherSwarmEntity : registry.enemySwarms.entities) {
-		if (swarmEntity.getId() != otherSwarmEntity.getId()) {
-			Motion& otherSwarmMotion = registry.motions.get(otherSwarmEntity);
-			float distance = sqrt(pow(swarmMotion.position.x - otherSwarmMotion.position.x, 2) +
-				pow(swarmMotion.position.y - otherSwarmMotion.position.y, 2));
-			if (distance != 0 && distance < shortestDistance) {
-				shortestDistance = distance;
-				closestSwarmEntity = otherSwarmEntity;
-			}
-		}
+// Projectiles keep atan2 for their sprite rotation, but the velocity only needs the direction normalized.
+// A zero offset fires along +x like atan2(0, 0) did
+static vec2 aimVelocity(vec2 diff, float speed) {
+	float lengthSq = dot(diff, diff);
+	if (lengthSq == 0.f) {
+		return vec2(speed, 0.f);
 	}
-	return closestSwarmEntity;
+	return diff * (speed / sqrt(lengthSq));
 }
 
-void AISystem::swarmFireProjectileAtPlayer(Entity swarmEntity) {
+void AISystem::swarmFireProjectileAtPlayer(Entity swarmEntity, AIJobContext& job) {
 	EnemySwarm& swarm = registry.enemySwarms.get(swarmEntity);
-	Motion& swarmMotion = registry.motions.get(swarmEntity);
-	Motion& playerMotion = registry.motions.get(pickAPlayer());
-	vec2 diff = playerMotion.position - swarmMotion.position;
+	vec2 swarmPosition = registry.motions.get(swarmEntity).position;
+	vec2 diff = pickAPlayer(swarmEntity).position - swarmPosition;
 	float angle = atan2(diff.y, diff.x);
-	vec2 velocity = vec2(cos(angle) * swarm.projectileSpeed, sin(angle) * swarm.projectileSpeed);
-	if (bossMode.currentBossLevel == STAGE2) {
-		createHandProjectile(renderer, swarmMotion.position, velocity, angle, swarmEntity);
-	}
-	else {
-		createEnemyProjectile(renderer, swarmMotion.position, velocity, angle, swarmEntity);
-	}
+	vec2 velocity = aimVelocity(diff, swarm.projectileSpeed);
+	bool handProjectile = bossMode.currentBossLevel == STAGE2;
+	job.deferred.push_back([this, handProjectile, swarmPosition, velocity, angle, swarmEntity]() {
+		if (handProjectile) {
+			createHandProjectile(renderer, swarmPosition, velocity, angle, swarmEntity);
+		}
+		else {
+			createEnemyProjectile(renderer, swarmPosition, velocity, angle, swarmEntity);
+		}
+	});
 }
 
-void AISystem::stepEnemyCoord(float elapsed_ms, float width, float height) {
+void AISystem::stepEnemyCoord(AIJobContext& job) {
 	for (Entity headEntity : registry.enemyCoordHeads.entities) {
 		EnemyCoordHead& head = registry.enemyCoordHeads.get(headEntity);
-		if (head.timeToUpdateAi) {
+		if (registry.aiThinks.get(headEntity).thinkNow) {
 			Enemy& headStatus = registry.enemies.get(headEntity);
 			Entity tailEntity = head.belongToTail;
 			if (!headStatus.isDead) {
-				moveAwayfromOtherCoord(headEntity, tailEntity, elapsed_ms);
-			}
-			head.aiUpdateTimer = 0;
-			head.timeToUpdateAi = false;
-		}
-		else {
-			head.aiUpdateTimer += elapsed_ms;
-			if (head.aiUpdateTimer > head.aiUpdateTime) {
-				head.timeToUpdateAi = true;
+				moveAwayfromOtherCoord(headEntity, tailEntity, job);
 			}
 		}
 	}
 }
 
-void AISystem::moveAwayfromOtherCoord(Entity enemyEntity, Entity otherEnemyEntity, float elapsed_ms) {
+void AISystem::moveAwayfromOtherCoord(Entity enemyEntity, Entity otherEnemyEntity, AIJobContext& job) {
 	if (registry.motions.has(otherEnemyEntity)) {
 		Motion& enemyMotion = registry.motions.get(enemyEntity);
 		Motion& otherEnemyMotion = registry.motions.get(otherEnemyEntity);
 		EnemyCoordHead& enemyHead = registry.enemyCoordHeads.get(enemyEntity);
-		float distance = sqrt(pow(enemyMotion.position.x - otherEnemyMotion.position.x, 2) +
-			pow(enemyMotion.position.y - otherEnemyMotion.position.y, 2));
+		vec2 headToTail = otherEnemyMotion.position - enemyMotion.position;
 		// if head tail too close, move away from each other to maintain distance
-		if (distance < enemyHead.minDistFromTail) {
-			vec2 directionFromEnemyToOtherEnemy =
-				vec2(otherEnemyMotion.position.x - enemyMotion.position.x, otherEnemyMotion.position.y - enemyMotion.position.y);
-			vec2 oppositeOfDirection = vec2(directionFromEnemyToOtherEnemy.x * -1.f, directionFromEnemyToOtherEnemy.y * -1.f);
-			vec2 normalizedOppositeDirection = vec2(oppositeOfDirection.x / sqrt(pow(oppositeOfDirection.x, 2) + pow(oppositeOfDirection.y, 2)),
-				oppositeOfDirection.y / sqrt(pow(oppositeOfDirection.x, 2) + pow(oppositeOfDirection.y, 2)));
+		if (dot(headToTail, headToTail) < enemyHead.minDistFromTail * enemyHead.minDistFromTail) {
 			Enemy& enemyStatus = registry.enemies.get(enemyEntity);
-			enemyMotion.velocity = vec2(normalizedOppositeDirection.x * enemyStatus.speed, normalizedOppositeDirection.y * enemyStatus.speed);
-			vec2 normalizedDirection = vec2(directionFromEnemyToOtherEnemy.x / sqrt(pow(directionFromEnemyToOtherEnemy.x, 2) + pow(directionFromEnemyToOtherEnemy.y, 2)),
-				directionFromEnemyToOtherEnemy.y / sqrt(pow(directionFromEnemyToOtherEnemy.x, 2) + pow(directionFromEnemyToOtherEnemy.y, 2)));
+			job.steering.separate(enemyEntity, enemyMotion.position, otherEnemyMotion.position, enemyStatus.speed);
 			Enemy& otherEnemyStatus = registry.enemies.get(otherEnemyEntity);
-			otherEnemyMotion.velocity = vec2(normalizedDirection.x * otherEnemyStatus.speed, normalizedDirection.y * otherEnemyStatus.speed);
+			job.steering.separate(otherEnemyEntity, otherEnemyMotion.position, enemyMotion.position, otherEnemyStatus.speed);
 		}
 		else {
-			Entity playerOneEntity = registry.players.entities.front();
 			if (twoPlayer.inTwoPlayerMode) {
-				Entity playerTwoEntity = registry.players.entities.back();
-				Player& player1 = registry.players.get(playerOneEntity);
-				Player& player2 = registry.players.get(playerTwoEntity);
+				const AIPlayerSnapshot& player1 = players.front();
+				const AIPlayerSnapshot& player2 = players.back();
 				if (!player1.isDead) {
-					Motion& player1Motion = registry.motions.get(registry.players.entities.front());
-					handleCoordEnemyUpdate(player1Motion, enemyMotion, otherEnemyMotion, enemyEntity, otherEnemyEntity);
+					handleCoordEnemyUpdate(player1.position, enemyMotion, otherEnemyMotion, enemyEntity, otherEnemyEntity, job);
 				}
 				else {
-					Motion& player2Motion = registry.motions.get(registry.players.entities.back());
-					handleCoordEnemyUpdate(player2Motion, enemyMotion, otherEnemyMotion, enemyEntity, otherEnemyEntity);
+					handleCoordEnemyUpdate(player2.position, enemyMotion, otherEnemyMotion, enemyEntity, otherEnemyEntity, job);
 				}
 			}
 			else {
-				Entity playerOneEntity = registry.players.entities.front();
-				Player& player1 = registry.players.get(playerOneEntity);
 				// head running away from player
-				Motion& player1Motion = registry.motions.get(registry.players.entities.front());
+				vec2 player1Position = players.front().position;
 				// if head too close to player, then tail chases player, otherwise they both move randomly
-				float distance = sqrt(pow(enemyMotion.position.x - player1Motion.position.x, 2) +
-					pow(enemyMotion.position.y - player1Motion.position.y, 2));
-				if (distance < 300.f) {
-					handleCoordEnemyUpdate(player1Motion, enemyMotion, otherEnemyMotion, enemyEntity, otherEnemyEntity);
+				vec2 headToPlayer = player1Position - enemyMotion.position;
+				if (dot(headToPlayer, headToPlayer) < 300.f * 300.f) {
+					handleCoordEnemyUpdate(player1Position, enemyMotion, otherEnemyMotion, enemyEntity, otherEnemyEntity, job);
 				}
 				else {
-					setEnemyWonderingRandomly(enemyEntity);
-					setEnemyWonderingRandomly(otherEnemyEntity);
+					setEnemyWonderingRandomly(enemyEntity, job);
+					setEnemyWonderingRandomly(otherEnemyEntity, job);
 				}
 			}
 		}
 	}
 }
 
-void AISystem::handleCoordEnemyUpdate(Motion& playerMotion, Motion& enemyMotion, Motion& otherEnemyMotion, Entity enemyEntity, Entity otherEnemyEntity) {
+void AISystem::handleCoordEnemyUpdate(vec2 playerPosition, Motion& enemyMotion, Motion& otherEnemyMotion, Entity enemyEntity, Entity otherEnemyEntity, AIJobContext& job) {
 	// head moving away from player
-	vec2 directionHeadToPlayer =
-		vec2(playerMotion.position.x - enemyMotion.position.x, playerMotion.position.y - enemyMotion.position.y);
-	vec2 oppositeOfDirection = vec2(directionHeadToPlayer.x * -1.f, directionHeadToPlayer.y * -1.f);
-	vec2 normalizedOppositeDirection = vec2(oppositeOfDirection.x / sqrt(pow(oppositeOfDirection.x, 2) + pow(oppositeOfDirection.y, 2)),
-		oppositeOfDirection.y / sqrt(pow(oppositeOfDirection.x, 2) + pow(oppositeOfDirection.y, 2)));
 	Enemy& enemyStatus = registry.enemies.get(enemyEntity);
-	enemyMotion.velocity = vec2(normalizedOppositeDirection.x * enemyStatus.speed, normalizedOppositeDirection.y * enemyStatus.speed);
+	job.steering.flee(enemyEntity, enemyMotion.position, playerPosition, enemyStatus.speed);
 	// tail running towards player
-	vec2 directionTailToPlayer =
-		vec2(playerMotion.position.x - otherEnemyMotion.position.x, playerMotion.position.y - otherEnemyMotion.position.y);
-	vec2 normalizedDirection = vec2(directionTailToPlayer.x / sqrt(pow(directionTailToPlayer.x, 2) + pow(directionTailToPlayer.y, 2)),
-		directionTailToPlayer.y / sqrt(pow(directionTailToPlayer.x, 2) + pow(directionTailToPlayer.y, 2)));
 	Enemy& otherEnemyStatus = registry.enemies.get(otherEnemyEntity);
-	otherEnemyMotion.velocity = vec2(normalizedDirection.x * otherEnemyStatus.speed, normalizedDirection.y * otherEnemyStatus.speed);
+	job.steering.seek(otherEnemyEntity, otherEnemyMotion.position, playerPosition, otherEnemyStatus.speed);
 }
 
-Entity AISystem::pickAPlayer() {
-	Entity playerOneEntity = registry.players.entities.front();
-	Entity playerEntity = playerOneEntity;
+const AIPlayerSnapshot& AISystem::pickAPlayer(Entity enemyEntity) {
+	const AIPlayerSnapshot& player1 = players.front();
 	if (twoPlayer.inTwoPlayerMode) {
-		Entity playerTwoEntity = registry.players.entities.back();
-		Player& player1 = registry.players.get(playerOneEntity);
-		Player& player2 = registry.players.get(playerTwoEntity);
-		if (uniform_dist(rng) > 0.5) {
+		const AIPlayerSnapshot& player2 = players.back();
+		if (gameRandom(enemyEntity, RANDOM_PURPOSE::PICK_PLAYER) > 0.5) {
 			if (!player2.isDead) {
-				playerEntity = playerTwoEntity;
+				return player2;
 			}
 		}
 		else {
 			if (player1.isDead) {
-				playerEntity = playerTwoEntity;
+				return player2;
 			}
 		}
 	}
-	return playerEntity;
-}
-
-int AISystem::findMin(vec2 upSumCost, vec2 rightSumCost, vec2 downSumCost, vec2 leftSumCost) {
-	float currMin = INT_MAX;
-	int currMinPosition = -1;
-	// UP
-	if (upSumCost.x + upSumCost.y < currMin) {
-		currMin = upSumCost.x + upSumCost.y;
-		currMinPosition = 0;
-	}	// RIGHT
-	if (rightSumCost.x + rightSumCost.y < currMin) {
-		currMin = rightSumCost.x + rightSumCost.y;
-		currMinPosition = 1;
-	}	// DOWN
-	if (downSumCost.x + downSumCost.y < currMin) {
-		currMin = downSumCost.x + downSumCost.y;
-		currMinPosition = 2;
-	}	// LEFT
-	if (leftSumCost.x + leftSumCost.y < currMin) {
-		currMin = leftSumCost.x + leftSumCost.y;
-		currMinPosition = 3;
-	}
-	return currMinPosition;
+	return player1;
 }
 
-vec2 AISystem::findFinalPosition(vec2 currNode, Entity& enemy, float width, float height, int currMinPosition) {
-	int finX = currNode.x;
-	int finY = currNode.y;
-
-	// depending on the min direction, choose that one, and made it the finX, finY
-	switch (currMinPosition) {
-	case 0: // up
-		if (currNode.y - registry.enemyAStars.get(enemy).stepSizes > 0.f) {
-			finY = currNode.y - registry.enemyAStars.get(enemy).stepSizes;
-		}
-		break;
-	case 1: // right
-		if (currNode.x + registry.enemyAStars.get(enemy).stepSizes < width) {
-			finX = currNode.x + registry.enemyAStars.get(enemy).stepSizes;
-		}
-		break;
-	case 2: // down
-		if (currNode.y + registry.enemyAStars.get(enemy).stepSizes < height) {
-			finY = currNode.y + registry.enemyAStars.get(enemy).stepSizes;
+void AISystem::followBacteriaPath(Entity bacteriaEntity, EnemyBacteria& bacteria, AIJobContext& job) {
+	Motion& motion = registry.motions.get(bacteriaEntity);
+	float reachedDistance = getNavGrid().cellSize / 2.f;
+	while (!bacteria.waypoints.empty()) {
+		vec2 diff = bacteria.waypoints.front() - motion.position;
+		if (dot(diff, diff) > reachedDistance * reachedDistance) {
+			break;
 		}
-		break;
-	case 3: // left
-		if (currNode.x - registry.enemyAStars.get(enemy).stepSizes > 0.f) {
-			finX = currNode.x - registry.enemyAStars.get(enemy).stepSizes;
-		}
-		break;
-	default:
-		break;
+		bacteria.waypoints.pop();
 	}
-
-	return { finX, finY };
-
-}
-
-vec2 AISystem::nextNode(vec2 currNode, Entity& player, Entity& enemy, float width, float height) {
-	Motion& motionAStar = registry.motions.get(enemy);
-	Motion& motionPlayer = registry.motions.get(player);
-	// Calculate H Cost value (distance between current node and the end position) and G Cost (distance between current node and the NEXT position)
-	// Add the sum of these two.
-	vec2 upHCost = abs(calculateHCost(motionPlayer, { currNode.x, currNode.y - registry.enemyAStars.get(enemy).stepSizes }));
-	vec2 upSumCost = abs(calculateGCost(enemy, 0)) + upHCost;
-
-	// RIGHT
-	vec2 rightHCost = abs(calculateHCost(motionPlayer, { currNode.x + registry.enemyAStars.get(enemy).stepSizes, currNode.y }));
-	vec2 rightSumCost = abs(calculateGCost(enemy, 1)) + rightHCost;
-
-	// DOWN
-	vec2 downHCost = abs(calculateHCost(motionPlayer, { currNode.x, currNode.y + registry.enemyAStars.get(enemy).stepSizes }));
-	vec2 downSumCost = abs(calculateGCost(enemy, 2)) + downHCost;
-
-	// LEFT
-	vec2 leftHCost = abs(calculateHCost(motionPlayer, { currNode.x - registry.enemyAStars.get(enemy).stepSizes, currNode.y }));
-	vec2 leftSumCost = abs(calculateGCost(enemy, 3)) + leftHCost;
-	// Find the min of all the values
-	
-	int currMinPosition = findMin(upSumCost, rightSumCost, downSumCost, leftSumCost);
-	vec2 finalPosition = findFinalPosition(currNode, enemy, width, height, currMinPosition);
-
-	// push the next node the queue and return the node
-	std::pair<int, int> currPosition = { finalPosition.x , finalPosition.y };
-	registry.enemyAStars.get(enemy).traversalQueue.push(currPosition);
-	return { finalPosition.x, finalPosition.y };
-}
-
-// Distance between enemy and endgoal
-vec2 AISystem::calculateHCost(const Motion& player, vec2 currNode) {
-	float distanceX = abs(player.position.x - currNode.x);
-	float distanceY = abs(player.position.y - currNode.y);
-
-	return { distanceX, distanceY };
-}
-
-// Distance between enemy and next position
-vec2 AISystem::calculateGCost(Entity& enemy, int dir) {
-	float distanceX = 0.f;
-	float distanceY = 0.f;
-	if (dir == 0) {			// up
-		distanceY = registry.enemyAStars.get(enemy).stepSizes;
-	}
-	else if (dir == 1) {	// right
-		distanceX = registry.enemyAStars.get(enemy).stepSizes;
+	// no path yet, or the last waypoint is reached, head straight for the player
+	vec2 target = bacteria.targetPlayer < (int)players.size() ? players[bacteria.targetPlayer].position : motion.position;
+	if (!bacteria.waypoints.empty()) {
+		target = bacteria.waypoints.front();
 	}
-	else if (dir == 2) {	// down
-		distanceY = registry.enemyAStars.get(enemy).stepSizes;
+	vec2 direction = target - motion.position;
+	if (dot(direction, direction) > 0.f) {
+		direction = normalize(direction);
 	}
-	else if (dir == 3) {	// left
-		distanceX = registry.enemyAStars.get(enemy).stepSizes;
-	}
-
-	return { distanceX, distanceY };
+	job.steering.setVelocity(bacteriaEntity, direction * registry.enemies.get(bacteriaEntity).speed);
 }
 
-void AISystem::handleAStarPathCalculation(Entity& player, Entity& enemy, float width, float height) {
-	Motion& motionAStar = registry.motions.get(enemy);
-	Motion& motionPlayer = registry.motions.get(player);
-	vec2 finNode = { motionPlayer.position.x, motionPlayer.position.y };
+void AISystem::handleAStarPathCalculation(vec2 playerPosition, Entity& enemy, AIJobContext& job) {
+	vec2 start = registry.motions.get(enemy).position;
+	Entity agent = enemy;
+	// the queue is shared with the bacteria job, requests are merged on the main thread
+	job.deferred.push_back([this, agent, start, playerPosition]() {
+		pathRequests.request(agent, start, playerPosition);
+	});
+}
 
-	vec2 currNode = { motionAStar.position.x, motionAStar.position.y };
-	while (abs(currNode.x - finNode.x) > registry.enemyAStars.get(enemy).distanceCloseToPlayer 
-		&& abs(currNode.y - finNode.y) > registry.enemyAStars.get(enemy).distanceCloseToPlayer) {
-		currNode = nextNode(currNode, player, enemy, width, height);
+void AISystem::processPathRequests() {
+	if (!hasNavGrid()) {
+		return;
+	}
+	pathRequests.process(getNavGrid());
+	for (const PathRequestQueue::PathResult& result : pathRequests.completed) {
+		// the enemy may have died while its request was queued, and without a route it keeps its previous path
+		if (result.found && registry.enemyAStars.has(result.agent)) {
+			registry.enemyAStars.get(result.agent).traversalQueue = result.path;
+		}
+		else if (result.found && registry.enemyBacterias.has(result.agent)) {
+			registry.enemyBacterias.get(result.agent).waypoints = result.path;
+		}
 	}
+	pathRequests.completed.clear();
 }
 
-void AISystem::pathCalculationInit(Entity& enemyAStar, float width, float height) {
+void AISystem::pathCalculationInit(Entity& enemyAStar, AIJobContext& job) {
 	EnemyAStar& aStarEnemy = registry.enemyAStars.get(enemyAStar);
-	aStarEnemy.finishedPathCalculation = false;
 	aStarEnemy.next_AStar_behaviour_calculation = aStarEnemy.AStarBehaviourUpdateTime;
-	Entity player = pickAPlayer();
-	Motion& playerMotion = registry.motions.get(player);
-	handleAStarPathCalculation(player, enemyAStar, width, height);
+	handleAStarPathCalculation(pickAPlayer(enemyAStar).position, enemyAStar, job);
 }
 
-void AISystem::stepMovement(Entity& enemyAStar) {
+void AISystem::stepMovement(Entity& enemyAStar, AIJobContext& job) {
 	EnemyAStar& aStarEnemy = registry.enemyAStars.get(enemyAStar);
 	Motion AStarMotion = registry.motions.get(enemyAStar);
 	aStarEnemy.next_bacteria_movement = aStarEnemy.movementUpdateTime;
-	if (!aStarEnemy.traversalQueue.empty()) {
-		std::pair<int, int> currPosition = { -1 , -1 };
-		currPosition = aStarEnemy.traversalQueue.front();
+	// drop the waypoints that have already been reached
+	while (!aStarEnemy.traversalQueue.empty()) {
+		vec2 currPosition = aStarEnemy.traversalQueue.front();
+		vec2 diff = currPosition - AStarMotion.position;
+		if (dot(diff, diff) > aStarEnemy.waypointReachedDistance * aStarEnemy.waypointReachedDistance) {
+			moveToSpot(AStarMotion.position.x, AStarMotion.position.y, currPosition.x, currPosition.y, enemyAStar, job);
+			break;
+		}
 		aStarEnemy.traversalQueue.pop();
-		moveToSpot(AStarMotion.position.x, AStarMotion.position.y, currPosition.first, currPosition.second, enemyAStar);
+	}
+	// a path cut short at the buffer capacity is planned again from where it ended
+	if (aStarEnemy.traversalQueue.empty() && aStarEnemy.traversalQueue.truncated) {
+		pathCalculationInit(enemyAStar, job);
 	}
 }
 
-void AISystem::stepEnemyAStar(float elapsed_ms, float width, float height) {
+void AISystem::stepEnemyAStar(float elapsed_ms, AIJobContext& job) {
 	for (Entity& entityAStar : registry.enemyAStars.entities) {  
-		Enemy& enemy = registry.enemies.get(entityAStar);
-		Motion AStarMotion = registry.motions.get(entityAStar);
 		EnemyAStar& aStarEnemy = registry.enemyAStars.get(entityAStar);
-		if (!enemy.isDead) {
-			aStarEnemy.next_AStar_behaviour_calculation -= elapsed_ms;
+		AI_LOD_TIER tier = getAILodTier(entityAStar);
+		if (tier != AI_LOD_TIER::FROZEN) {
 			aStarEnemy.next_bacteria_movement -= elapsed_ms;
+			// far from the players the enemy keeps walking its current path instead of asking for a new one
+			if (tier == AI_LOD_TIER::FULL) {
+				aStarEnemy.next_AStar_behaviour_calculation -= elapsed_ms;
+			}
 			if (aStarEnemy.next_AStar_behaviour_calculation < 0.f) {
-				pathCalculationInit(entityAStar, width, height);
+				pathCalculationInit(entityAStar, job);
 			}
 
 			if (aStarEnemy.next_bacteria_movement < 0.f) {
-				stepMovement(entityAStar);
+				stepMovement(entityAStar, job);
 			}
 		}
 	}
 }
 
-void AISystem::bossFireProjectileAtPlayer(Entity entity) {
+void AISystem::bossFireProjectileAtPlayer(Entity entity, AIJobContext& job) {
 	EnemyBoss& boss = registry.enemyBoss.get(entity);
 	Motion& bossMotion = registry.motions.get(entity);
-	Motion& playerMotion = registry.motions.get(pickAPlayer());
-	vec2 diff = playerMotion.position - bossMotion.position;
+	vec2 diff = pickAPlayer(entity).position - bossMotion.position;
 	float angle = atan2(diff.y, diff.x);
-	vec2 velocity = vec2(cos(angle) * boss.projectileSpeed, sin(angle) * boss.projectileSpeed);
-	createHandProjectile(renderer, vec2(bossMotion.position.x, BOSS_BB_HEIGHT * defaultResolution.scaling), velocity, angle, entity);
+	vec2 velocity = aimVelocity(diff, boss.projectileSpeed);
+	vec2 position = vec2(bossMotion.position.x, BOSS_BB_HEIGHT * defaultResolution.scaling);
+	job.deferred.push_back([this, position, velocity, angle, entity]() {
+		createHandProjectile(renderer, position, velocity, angle, entity);
+	});
 }
 
 
-void AISystem::stepEnemyBoss(float elapsed_ms) {
+void AISystem::stepEnemyBoss(AIJobContext& job) {
 	if (bossMode.currentBossLevel == STAGE3 && registry.enemyBoss.entities.size() > 0) {
 		Entity bossEntity = registry.enemyBoss.entities.front();
-		EnemyBoss& boss = registry.enemyBoss.get(bossEntity);
-		if (boss.timeToUpdateAi) {
-			bossFireProjectileAtPlayer(bossEntity);
-			boss.timeToUpdateAi = false;
-			boss.aiUpdateTimer = 0;
-		}
-		else {
-			boss.aiUpdateTimer += elapsed_ms;
-			if (boss.aiUpdateTimer > boss.aiUpdateInterval) {
-				boss.timeToUpdateAi = true;
-			}
+		if (registry.aiThinks.get(bossEntity).thinkNow) {
+			bossFireProjectileAtPlayer(bossEntity, job);
 		}
 	}
 }
\ No newline at end of file
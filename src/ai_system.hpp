@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <map>
@@ -9,60 +10,122 @@
 #include "tiny_ecs_registry.hpp"
 #include "common.hpp"
 #include "world_init.hpp"
+#include "nav_grid.hpp"
+#include "flow_field.hpp"
+#include "path_finder.hpp"
+#include "behaviour_tree.hpp"
+#include "ai_scheduler.hpp"
+#include "ai_lod.hpp"
+#include "spatial_query.hpp"
+#include "steering.hpp"
+#include "worker_pool.hpp"
+#include "random.hpp"
+
+// The AI step runs one job per enemy archetype, in this order
+enum class AI_JOB {
+	HUNTER = 0,
+	BACTERIA = HUNTER + 1,
+	CHASE = BACTERIA + 1,
+	SWARM = CHASE + 1,
+	COORD = SWARM + 1,
+	GERM = COORD + 1,
+	ASTAR = GERM + 1,
+	BOSS = ASTAR + 1,
+	JOB_COUNT = BOSS + 1
+};
+const int ai_job_count = (int)AI_JOB::JOB_COUNT;
+
+// A player as the AI sees it for the whole step
+struct AIPlayerSnapshot
+{
+	Entity entity;
+	vec2 position;
+	bool isDead;
+};
+
+// Everything an archetype job may write while it runs on a worker. Jobs only read the registry,
+// the snapshot and the spatial grid, and draw random numbers from random.hpp keyed by entity.
+// Their buffers are merged on the main thread in job order once every job finished, so the
+// outcome does not depend on the number of workers
+struct AIJobContext
+{
+	SteeringBatch steering;
+	// registry changes and spawns, run after the jobs since other jobs may be reading the registry
+	std::vector<std::function<void()>> deferred;
+	std::vector<Entity> neighbours;
+};
 
 class AISystem
 {
 public:
-	AISystem(RenderSystem* renderer_arg) {
-		rng = std::default_random_engine(std::random_device()());
+	// The main thread takes jobs too, a helper past the job count would only ever wake up idle
+	AISystem(RenderSystem* renderer_arg) : workers(std::min(WorkerPool::defaultThreadCount(), ai_job_count - 1)) {
 		this->renderer = renderer_arg;
+		buildGermBehaviourTree();
 	}
 	void step(float elapsed_ms, float width, float height);
+	// Caps how many agents may update their AI on a single frame, 0 (the default) for no limit
+	void setMaxAgentsThinkingPerFrame(int maxAgents) { scheduler.maxAgentsPerFrame = maxAgents; };
+	// Number of enemies that ran the given AI tier on the last step, for profiling
+	int getAILodTierCount(AI_LOD_TIER tier) const { return lod.tierCounts[(int)tier]; };
+	// Threads helping the main thread run the archetype jobs, 0 runs them all on the main thread
+	void setWorkerCount(int workerCount) { workers.setThreadCount(workerCount); };
+	// Checks every batched steering result against the trig reference in debug builds, off by default
+	// since the reference allocates and runs the full scalar kernel for every job on every step
+	void setSteeringValidation(bool enabled) { validateSteering = enabled; };
 
 private:
 	RenderSystem* renderer;
-	bool blocksInitialized = false;
-	std::vector<int> path;
-	std::pair<int, int> pred[8][8]{};
-	std::pair<int, int> adj[8][8]{};
-	std::pair<int, int> calculations[8][8]{};
+	// staggers hunter, chase, swarm, coord head and boss think ticks across frames
+	AIScheduler scheduler;
+	// full, reduced or frozen AI per enemy, picked before the scheduler runs
+	AILodSelector lod;
+	// enemy and player positions bucketed once per step, every neighbour lookup goes through it
+	SpatialQuery spatialQuery;
+	// players taken once per step, before the jobs start
+	std::vector<AIPlayerSnapshot> players;
+	bool playersAllAlive = true;
+	WorkerPool workers;
+	AIJobContext jobs[ai_job_count];
+	bool validateSteering = false;
 
-	bool visited[8][8]{};
-	std::default_random_engine rng;
-	std::uniform_real_distribution<float> uniform_dist;
+	// one flow field per player, shared by every enemy chasing that player
+	std::vector<FlowField> playerFlowFields;
+	// A* requests are solved here under a per-frame budget before the jobs start, agents keep their old path meanwhile
+	PathRequestQueue pathRequests;
+	// shared by every germ, per-germ state lives in its BTBlackboard
+	BehaviourTree germTree;
+	void buildGermBehaviourTree();
+	void takePlayerSnapshot();
+	void runJob(AI_JOB type, float elapsed_ms);
+	// swaps the enemy's sprite once the jobs finished
+	void deferTexture(AIJobContext& job, Entity entity, TEXTURE_ASSET_ID texture);
 	bool isEnemyInRangeOfThePlayers(Entity enemyEntity);
-	float enemyDistanceFromPlayer(const Motion& player, const Motion& hunter);
-	void setEnemyWonderingRandomly(Entity enemyEntity);
-	void setEnemyChasingThePlayer(Entity enemyEntity);
-	Entity determineWhichPlayerToChase(Entity hunterEntity);
-	void stepEnemyHunter(float elapsed_ms);
-	void resolveHunterAnimation(Entity hunterEntity, Enemy& hunterStatus, EnemyHunter& hunter);
-	void stepEnemyChase(float elapsed_ms);
-	void stepEnemyAStar(float elapsed_ms, float width, float height);
-	void stepEnemyGerm(float elapsed_ms);
-	void stepEnemyBacteria(float elapsed_ms, const float width, const float height);
-	void stepEnemySwarm(float elapsed_ms);
-	void stepEnemyCoord(float elapsed_ms, float width, float height);
-	void moveAwayfromOtherCoord(Entity enemyEntity, Entity otherEnemyEntity, float elapsed_ms);
-	void handleCoordEnemyUpdate(Motion& playerMotion, Motion& enemyMotion, Motion& otherEnemyMotion, Entity enemyEntity, Entity otherEnemyEntity);
-	void stepEnemyBoss(float elapsed_ms);
-	bool handlePath(float width, float height, Entity& bacteriaEntity);
-	void bfsSearchPath(float initX, float initY, float finX, float finY, Entity& bacteriaEntity, float width, float height);
-	void moveToSpot(float initX, float initY, float finalX, float finalY, Entity& bacteriaEntity);
-	void createAdj();
-	void findPath(Entity& bacteriaEntity);
-	void handleAStarPathCalculation(Entity& player, Entity& enemy, float width, float height);
-	vec2 calculateHCost(const Motion& player, vec2 currNode);
-	vec2 calculateGCost(Entity& enemy, int dir);
-	vec2 nextNode(vec2 currNode, Entity& player, Entity& enemy, float width, float height);
-	void stepMovement(Entity& enemyAStar);
-	vec2 findFinalPosition(vec2 currNode, Entity& enemy, float width, float height, int currMinPosition);
-	void pathCalculationInit(Entity& enemyAStar, float width, float height);
-	int findMin(vec2 upSumCost, vec2 rightSumCost, vec2 downSumCost, vec2 leftSumCost);
-	Entity pickAPlayer();
-	void swarmFireProjectileAtPlayer(Entity swarmEntity);
-	void bossFireProjectileAtPlayer(Entity entity);
-	void swarmSpreadOut(Entity swarmEntity);
-	Entity findClosestSwarm(Entity swarmEntity);
-	void moveAwayfromOtherSwarm(Entity enemyEntity, Entity otherEnemyEntity);
-};
\ No newline at end of file
+	void setEnemyWonderingRandomly(Entity enemyEntity, AIJobContext& job);
+	void setEnemyChasingThePlayer(Entity enemyEntity, AIJobContext& job);
+	const AIPlayerSnapshot& determineWhichPlayerToChase(Entity hunterEntity);
+	void stepEnemyHunter(AIJobContext& job);
+	void resolveHunterAnimation(Entity hunterEntity, Enemy& hunterStatus, EnemyHunter& hunter, AIJobContext& job);
+	void stepEnemyChase(float elapsed_ms, AIJobContext& job);
+	void stepEnemyAStar(float elapsed_ms, AIJobContext& job);
+	void stepEnemyGerm(float elapsed_ms, AIJobContext& job);
+	void stepEnemyBacteria(float elapsed_ms, AIJobContext& job);
+	void stepEnemySwarm(AIJobContext& job);
+	void stepEnemyCoord(AIJobContext& job);
+	void moveAwayfromOtherCoord(Entity enemyEntity, Entity otherEnemyEntity, AIJobContext& job);
+	void handleCoordEnemyUpdate(vec2 playerPosition, Motion& enemyMotion, Motion& otherEnemyMotion, Entity enemyEntity, Entity otherEnemyEntity, AIJobContext& job);
+	void stepEnemyBoss(AIJobContext& job);
+	void updatePlayerFlowFields();
+	void followFlowField(Entity enemyEntity, int playerIndex, AIJobContext& job);
+	void followBacteriaPath(Entity bacteriaEntity, EnemyBacteria& bacteria, AIJobContext& job);
+	void moveToSpot(float initX, float initY, float finalX, float finalY, Entity& bacteriaEntity, AIJobContext& job);
+	void handleAStarPathCalculation(vec2 playerPosition, Entity& enemy, AIJobContext& job);
+	void processPathRequests();
+	void stepMovement(Entity& enemyAStar, AIJobContext& job);
+	void pathCalculationInit(Entity& enemyAStar, AIJobContext& job);
+	const AIPlayerSnapshot& pickAPlayer(Entity enemyEntity);
+	void swarmFireProjectileAtPlayer(Entity swarmEntity, AIJobContext& job);
+	void bossFireProjectileAtPlayer(Entity entity, AIJobContext& job);
+	void swarmSpreadOut(Entity swarmEntity, AIJobContext& job);
+	void moveAwayfromOtherSwarm(Entity enemyEntity, Entity otherEnemyEntity, AIJobContext& job);
+};
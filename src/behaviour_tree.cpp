@@ -0,0 +1,79 @@
+// internal
+#include "behaviour_tree.hpp"
+
+int BehaviourTree::addNode(BT_NODE_TYPE type) {
+	BTNode node;
+	node.type = type;
+	nodes.push_back(node);
+	// every open ancestor grows by the new node
+	for (int open : openNodes) {
+		nodes[open].subtreeSize++;
+	}
+	return (int)nodes.size() - 1;
+}
+
+void BehaviourTree::beginSequence() {
+	assert(sequenceCount < BTBlackboard::MAX_SEQUENCES);
+	int index = addNode(BT_NODE_TYPE::SEQUENCE);
+	nodes[index].sequenceSlot = sequenceCount++;
+	openNodes.push_back(index);
+}
+
+void BehaviourTree::beginIfCondition(BTCondition condition) {
+	int index = addNode(BT_NODE_TYPE::IF_CONDITION);
+	nodes[index].condition = condition;
+	openNodes.push_back(index);
+}
+
+void BehaviourTree::end() {
+	assert(!openNodes.empty());
+	openNodes.pop_back();
+}
+
+void BehaviourTree::action(BTAction action) {
+	int index = addNode(BT_NODE_TYPE::ACTION);
+	nodes[index].action = action;
+}
+
+BT_STATE BehaviourTree::tick(Entity entity, BTBlackboard& blackboard) const {
+	assert(openNodes.empty() && !nodes.empty());
+	return tickNode(0, entity, blackboard);
+}
+
+BT_STATE BehaviourTree::tickNode(int index, Entity entity, BTBlackboard& blackboard) const {
+	const BTNode& node = nodes[index];
+	switch (node.type) {
+	case BT_NODE_TYPE::ACTION:
+		return node.action(entity, blackboard);
+	case BT_NODE_TYPE::IF_CONDITION:
+		if (node.subtreeSize > 1 && node.condition(entity, blackboard)) {
+			return tickNode(index + 1, entity, blackboard);
+		}
+		return BT_STATE::SUCCESS;
+	case BT_NODE_TYPE::SEQUENCE: {
+		unsigned char& runningChild = blackboard.runningChild[node.sequenceSlot];
+		// skip to the child that was still running on the last tick
+		int child = index + 1;
+		for (int i = 0; i < runningChild; i++) {
+			child += nodes[child].subtreeSize;
+		}
+		int childIndex = runningChild;
+		while (child < index + node.subtreeSize) {
+			BT_STATE state = tickNode(child, entity, blackboard);
+			if (state == BT_STATE::RUNNING) {
+				runningChild = (unsigned char)childIndex;
+				return state;
+			}
+			if (state == BT_STATE::FAILURE) {
+				runningChild = 0;
+				return state;
+			}
+			child += nodes[child].subtreeSize;
+			childIndex++;
+		}
+		runningChild = 0;
+		return BT_STATE::SUCCESS;
+	}
+	}
+	return BT_STATE::FAILURE;
+}
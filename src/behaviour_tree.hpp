@@ -0,0 +1,58 @@
+#pragma once
+
+// stlib
+#include <vector>
+
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+
+enum class BT_STATE {
+	RUNNING = 0,
+	SUCCESS = RUNNING + 1,
+	FAILURE = SUCCESS + 1
+};
+
+enum class BT_NODE_TYPE {
+	// runs children in order and stops at the first that does not succeed
+	SEQUENCE = 0,
+	// runs its only child when the condition holds, otherwise succeeds without running it
+	IF_CONDITION = SEQUENCE + 1,
+	// leaf that modifies the world
+	ACTION = IF_CONDITION + 1
+};
+
+typedef BT_STATE (*BTAction)(Entity entity, BTBlackboard& blackboard);
+typedef bool (*BTCondition)(Entity entity, const BTBlackboard& blackboard);
+
+// A behaviour tree defined once and shared by every agent of a type. Nodes are stored flattened
+// in pre-order: a node's first child directly follows it and subtreeSize jumps to its next sibling.
+// All per-agent state lives in the agent's BTBlackboard, so ticking allocates nothing
+class BehaviourTree
+{
+public:
+	// Building, every begin has a matching end
+	void beginSequence();
+	void beginIfCondition(BTCondition condition);
+	void end();
+	void action(BTAction action);
+
+	BT_STATE tick(Entity entity, BTBlackboard& blackboard) const;
+
+private:
+	struct BTNode {
+		BT_NODE_TYPE type;
+		// number of nodes in this subtree, itself included
+		int subtreeSize = 1;
+		// blackboard slot holding the running child of a sequence
+		int sequenceSlot = -1;
+		BTAction action = nullptr;
+		BTCondition condition = nullptr;
+	};
+	std::vector<BTNode> nodes;
+	// nodes begun but not yet ended, only used while building
+	std::vector<int> openNodes;
+	int sequenceCount = 0;
+
+	int addNode(BT_NODE_TYPE type);
+	BT_STATE tickNode(int index, Entity entity, BTBlackboard& blackboard) const;
+};
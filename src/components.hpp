@@ -4,8 +4,7 @@
 #include <unordered_map>
 #include "../ext/stb_image/stb_image.h"
 #include "../ext/json/dist/json/json.h" 
-#include <queue>
-#include <stack>
+#include "path_buffer.hpp"
 
 enum AttackDirection {
 	UP,
@@ -100,8 +99,6 @@ struct EnemyChase
 	int counter_value = 2000;
 	int counter_other_en_chase_value = 800;
 	float aiUpdateTime = 100.f;
-	float aiUpdateTimer = 0;
-	bool timeToUpdateAi = true;
 };
 
 // Enemy that will be attacked by wizard using projectile and tries to run away from wizard
@@ -119,25 +116,20 @@ struct EnemyHunter
 	int huntingMode = 1;
 	int fleeingMode = 2;
 	float aiUpdateTime = 1000.f;
-	float aiUpdateTimer = 0;
-	bool timeToUpdateAi = true;
 	bool isFleeing = false;
 	float huntingRange = 500.f;
 	bool isAnimatingHurt = false;
 };
 
-// BFS Enemy
+// BFS Enemy, follows the flow field of the player it targets
 struct EnemyBacteria
 {
-	bool huntingMode = true;
-	float bfsUpdateTime = 3000.f;
-	float pathUpdateTime = 500.f;
-	float finX = 0;
-	float finY = 0;
-	std::stack<std::pair<int, int>> traversalStack;
-	std::queue<std::pair<int, int>> adjacentsQueue;
-	float next_bacteria_BFS_calculation;
-	float next_bacteria_PATH_calculation;
+	float targetUpdateTime = 3000.f;
+	float next_target_calculation = 0;
+	// index into registry.players
+	int targetPlayer = 0;
+	// hierarchical path toward the target on large arenas, small ones follow the players' flow fields
+	PathBuffer waypoints;
 };
 
 // Behaviour Tree Enemy
@@ -151,6 +143,50 @@ struct EnemyGerm
 	float playerChaseThreshold = 5;
 };
 
+// Per-agent behaviour tree state, see behaviour_tree.hpp. The owning system writes the facts
+// the tree reads once per tick so nodes do not query the registry for them
+struct BTBlackboard
+{
+	static const int MAX_SEQUENCES = 4;
+	// resume point of every sequence node in the agent's tree
+	unsigned char runningChild[MAX_SEQUENCES] = {};
+	vec2 targetPosition = { 0, 0 };
+	bool playersAllAlive = true;
+	// random velocity multipliers rolled by the AI step before each tick
+	ivec2 explosionRoll = { 0, 0 };
+	// velocity chosen by the tick, applied with the rest of the AI step's steering
+	vec2 velocity = { 0, 0 };
+	bool hasVelocity = false;
+	// set instead of velocity to seek targetPosition at the enemy's speed through the steering batch
+	bool seeksTarget = false;
+};
+
+// Think cadence of an AI agent, see ai_scheduler.hpp
+struct AIThink
+{
+	float interval = 1000.f;
+	// ms until the next think, negative while the agent is overdue
+	float timer = 0;
+	// set by the scheduler on the frames this agent should update its AI
+	bool thinkNow = false;
+};
+
+// How much AI an enemy runs, see ai_lod.hpp
+enum class AI_LOD_TIER {
+	FULL = 0,
+	REDUCED = FULL + 1,
+	FROZEN = REDUCED + 1,
+	TIER_COUNT = FROZEN + 1
+};
+const int ai_lod_tier_count = (int)AI_LOD_TIER::TIER_COUNT;
+
+struct AILod
+{
+	AI_LOD_TIER tier = AI_LOD_TIER::FULL;
+	// velocity held while FROZEN, the enemy stands still and resumes with it when it thaws
+	vec2 thawVelocity = { 0, 0 };
+};
+
 // A* Enemy
 struct EnemyAStar
 {
@@ -158,19 +194,20 @@ struct EnemyAStar
 	float AStarBehaviourUpdateTime = 1500.f;
 	float next_AStar_behaviour_calculation;
 	float next_bacteria_movement;
-	float stepSizes = 200.f;
-	float distanceCloseToPlayer = 100.f;
-	std::queue<std::pair<int, int>> traversalQueue;
-	bool finishedPathCalculation = false;
-	bool isXCalculationFinished = false;
-	bool isYCalculationFinished = false;
+	// a waypoint closer than this counts as reached
+	float waypointReachedDistance = 40.f;
+	// turning points of the current A* path, in screen coordinates
+	PathBuffer traversalQueue;
 };
 
+// path buffers keep the pathing enemies allocation free and cheap to move around their containers
+static_assert(std::is_trivially_copyable<EnemyBacteria>::value, "EnemyBacteria must stay memcpy-able");
+static_assert(std::is_trivially_copyable<EnemyAStar>::value, "EnemyAStar must stay memcpy-able");
+
 struct EnemySwarm {
 	float aiUpdateTime = 3000.f;
-	// Wait 1000ms before update AI for the first time so it doesn't fire at the player right after level loads
-	float aiUpdateTimer = 1000.f;
-	bool timeToUpdateAi = false;
+	// Wait before updating AI for the first time so it doesn't fire at the player right after level loads
+	float firstAiUpdateDelay = 2000.f;
 	float projectileSpeed = 150.f;
 	float spreadOutDistance = 200.f;
 	bool isAnimatingHurt = false;
@@ -178,8 +215,6 @@ struct EnemySwarm {
 
 struct EnemyCoordHead {
 	float aiUpdateTime = 2000.f;
-	float aiUpdateTimer = 0;
-	bool timeToUpdateAi = true;
 	float minDistFromTail = 300.f;
 	Entity belongToTail;
 };
@@ -190,8 +225,6 @@ struct EnemyCoordTail {
 
 struct EnemyBoss {
 	float aiUpdateInterval = 1500.f;
-	float aiUpdateTimer = 0;
-	bool timeToUpdateAi = true;
 	float projectileSpeed = 150.f;
 };
 
@@ -216,6 +249,21 @@ struct Door
 
 };
 
+// Walkability grid over the whole level, built from blocks, walls and the door.
+// All path queries share it read-only, see nav_grid.hpp
+struct NavGrid
+{
+	float cellSize = 40.f;
+	// obstacles are grown by this much so an agent centred on a free cell does not clip them
+	float agentRadius = 30.f;
+	int cols = 0;
+	int rows = 0;
+	// number of obstacles overlapping each cell, a cell is walkable when its count is 0
+	std::vector<int> obstacleCount;
+	// bumped on every change so anything cached on top of the grid knows to recompute
+	unsigned int version = 0;
+};
+
 // All data relevant to the shape and motion of entities
 struct Motion {
 	vec2 position = { 0, 0 };
@@ -232,6 +280,25 @@ struct Collision
 	Collision(Entity& other) { this->other = other; };
 };
 
+// Broad category of an entity taking part in a collision, used to index the response table
+enum class COLLIDER_CATEGORY {
+	NONE = 0,
+	PLAYER = NONE + 1,
+	ENEMY = PLAYER + 1,
+	PROJECTILE = ENEMY + 1,
+	ENEMY_PROJECTILE = PROJECTILE + 1,
+	SWORD = ENEMY_PROJECTILE + 1,
+	POWERUP = SWORD + 1,
+	CATEGORY_COUNT = POWERUP + 1
+};
+const int collider_category_count = (int)COLLIDER_CATEGORY::CATEGORY_COUNT;
+
+// Collision category of an entity, set once by its creator and used to index the response table
+struct Collider
+{
+	COLLIDER_CATEGORY category = COLLIDER_CATEGORY::NONE;
+};
+
 // Data structure for toggling debug mode
 struct Debug {
 	bool in_debug_mode = 0;
@@ -604,7 +671,9 @@ enum class EFFECT_ASSET_ID {
 	POWERUP = NUMBER + 1,
 	LETTER = POWERUP + 1, 
 	BOSS = LETTER + 1,
-	EFFECT_COUNT = BOSS + 1
+	SPRITE_BATCH = BOSS + 1,
+	ENEMY_BATCH = SPRITE_BATCH + 1,
+	EFFECT_COUNT = ENEMY_BATCH + 1
 };
 const int effect_count = (int)EFFECT_ASSET_ID::EFFECT_COUNT;
 
@@ -633,6 +702,38 @@ struct RenderRequest {
 	GEOMETRY_BUFFER_ID used_geometry = GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
 };
 
+// Draw order bands, back to front. A later layer always covers an earlier one
+// whatever order the entities were created in
+enum class RENDER_LAYER {
+	BACKGROUND = 0,
+	// walls, the door and blocks
+	TERRAIN = BACKGROUND + 1,
+	// powerups lying on the shop floor
+	PICKUP = TERRAIN + 1,
+	// world sprites not given a band of their own
+	WORLD = PICKUP + 1,
+	// enemies, the boss and its hands
+	ENEMY = WORLD + 1,
+	// the knight and the wizard, over enemies so a player is never lost in a crowd
+	PLAYER = ENEMY + 1,
+	// the sword swing and every player or enemy projectile
+	PROJECTILE = PLAYER + 1,
+	// debug hitbox lines, over the sprites they outline
+	DEBUG = PROJECTILE + 1,
+	// HUD, text and tutorial hints
+	HUD = DEBUG + 1,
+	// menus, story and end scenes
+	SCREEN = HUD + 1,
+	// the help panel, also opened on top of menus and the story
+	HELP = SCREEN + 1,
+	LAYER_COUNT = HELP + 1
+};
+
+// Entities without one are drawn in the WORLD layer
+struct RenderLayer {
+	RENDER_LAYER layer = RENDER_LAYER::WORLD;
+};
+
 class LevelFileLoader {
 private: 
 	std::vector<Level> levels; 
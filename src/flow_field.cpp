@@ -0,0 +1,77 @@
+// internal
+#include "flow_field.hpp"
+
+// stlib
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+void updateFlowField(FlowField& field, const NavGrid& grid, vec2 target) {
+	ivec2 targetCell = navCellOf(grid, target);
+	int cellCount = grid.cols * grid.rows;
+	if (targetCell == field.targetCell && field.gridVersion == grid.version && (int)field.cost.size() == cellCount) {
+		return;
+	}
+	field.targetCell = targetCell;
+	field.gridVersion = grid.version;
+	field.cost.assign(cellCount, INT_MAX);
+	field.direction.assign(cellCount, vec2(0, 0));
+
+	// Dijkstra outward from the target, the target cell itself is seeded even if it hugs an obstacle
+	std::vector<std::pair<int, int>>& open = field.openList;
+	std::greater<std::pair<int, int>> cheapestFirst;
+	open.clear();
+	int targetIndex = navCellIndex(grid, targetCell);
+	field.cost[targetIndex] = 0;
+	open.push_back({ 0, targetIndex });
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), cheapestFirst);
+		std::pair<int, int> current = open.back();
+		open.pop_back();
+		if (current.first > field.cost[current.second]) {
+			continue;
+		}
+		ivec2 cell = { current.second % grid.cols, current.second / grid.cols };
+		for (const ivec2& offset : NAV_NEIGHBOUR_OFFSETS) {
+			if (!navCanStep(grid, cell, offset)) {
+				continue;
+			}
+			int nextIndex = navCellIndex(grid, cell + offset);
+			int nextCost = current.first + navStepCost(offset);
+			if (nextCost < field.cost[nextIndex]) {
+				field.cost[nextIndex] = nextCost;
+				open.push_back({ nextCost, nextIndex });
+				std::push_heap(open.begin(), open.end(), cheapestFirst);
+			}
+		}
+	}
+
+	// Point every cell at its cheapest neighbour. Blocked cells (agents pushed into an inflated
+	// obstacle) also get a direction so they can walk back out onto the grid
+	for (int index = 0; index < cellCount; index++) {
+		if (index == targetIndex) {
+			continue;
+		}
+		ivec2 cell = { index % grid.cols, index / grid.cols };
+		bool walkable = navCellWalkable(grid, cell);
+		int bestCost = walkable ? field.cost[index] : INT_MAX;
+		for (const ivec2& offset : NAV_NEIGHBOUR_OFFSETS) {
+			ivec2 next = cell + offset;
+			if (walkable ? !navCanStep(grid, cell, offset) : !navCellInBounds(grid, next)) {
+				continue;
+			}
+			int nextCost = field.cost[navCellIndex(grid, next)];
+			if (nextCost < bestCost) {
+				bestCost = nextCost;
+				field.direction[index] = normalize(vec2(offset));
+			}
+		}
+	}
+}
+
+vec2 sampleFlowField(const FlowField& field, const NavGrid& grid, vec2 position) {
+	if ((int)field.direction.size() != grid.cols * grid.rows) {
+		return vec2(0, 0);
+	}
+	return field.direction[navCellIndex(grid, navCellOf(grid, position))];
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common.hpp"
+#include "nav_grid.hpp"
+
+// Cheapest-route field toward a single target over the nav grid. It is computed once per
+// target and then sampled by any number of chasing enemies in O(1)
+struct FlowField
+{
+	ivec2 targetCell = { -1, -1 };
+	unsigned int gridVersion = 0;
+	// path cost to the target per cell, INT_MAX when unreachable
+	std::vector<int> cost;
+	// unit direction toward the cheapest neighbour per cell, zero at the target or when unreachable
+	std::vector<vec2> direction;
+	// open list reused between updates
+	std::vector<std::pair<int, int>> openList;
+};
+
+// Recomputes the field when the target moved to another cell or the grid changed
+void updateFlowField(FlowField& field, const NavGrid& grid, vec2 target);
+vec2 sampleFlowField(const FlowField& field, const NavGrid& grid, vec2 position);
@@ -0,0 +1,411 @@
+// internal
+#include "hierarchical_path.hpp"
+
+// stlib
+#include <algorithm>
+#include <functional>
+
+static ivec2 cellPosition(const NavGrid& grid, int index) {
+	return { index % grid.cols, index / grid.cols };
+}
+
+bool HierarchicalPathFinder::findPath(const NavGrid& grid, vec2 start, vec2 goal, std::vector<vec2>& path) {
+	lastAbstractExpansions = 0;
+	lastLocalExpansions = 0;
+	path.clear();
+	prepare(grid);
+
+	ivec2 startCell = navCellOf(grid, start);
+	ivec2 goalCell = navCellOf(grid, goal);
+	if (startCell == goalCell) {
+		return true;
+	}
+	// like the flat search, a neighbouring goal is entered even when it hugs an obstacle
+	if (abs(startCell.x - goalCell.x) <= 1 && abs(startCell.y - goalCell.y) <= 1) {
+		path.push_back(navCellCenter(grid, goalCell));
+		return true;
+	}
+
+	// an agent or target standing in a blocked cell searches from the open cells around it instead
+	openNeighbours(grid, startCell, goalCell, true, startCandidates);
+	openNeighbours(grid, goalCell, startCell, false, goalCandidates);
+	for (int searchStart : startCandidates) {
+		for (int searchGoal : goalCandidates) {
+			if (searchBetween(grid, searchStart, searchGoal, path)) {
+				if (searchStart != navCellIndex(grid, startCell)) {
+					path.insert(path.begin(), navCellCenter(grid, cellPosition(grid, searchStart)));
+				}
+				if (searchGoal != navCellIndex(grid, goalCell)) {
+					path.push_back(navCellCenter(grid, goalCell));
+				}
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void HierarchicalPathFinder::prepare(const NavGrid& grid) {
+	if (graphVersion != grid.version || graphCols != grid.cols || graphRows != grid.rows) {
+		buildGraph(grid);
+	}
+}
+
+void HierarchicalPathFinder::openNeighbours(const NavGrid& grid, ivec2 cell, ivec2 towards, bool leaving, std::vector<int>& candidates) {
+	candidates.clear();
+	if (navCellWalkable(grid, cell)) {
+		candidates.push_back(navCellIndex(grid, cell));
+		return;
+	}
+	for (const ivec2& offset : NAV_NEIGHBOUR_OFFSETS) {
+		// stepping out of a cell keeps the corner rule, stepping into the goal does not
+		bool open = leaving ? navCanStep(grid, cell, offset) : navCellWalkable(grid, cell + offset);
+		if (open) {
+			candidates.push_back(navCellIndex(grid, cell + offset));
+		}
+	}
+	// closest to the other end first, the rest are only tried when it is cut off
+	std::sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+		return navOctileCost(cellPosition(grid, a), towards) < navOctileCost(cellPosition(grid, b), towards);
+	});
+}
+
+bool HierarchicalPathFinder::searchBetween(const NavGrid& grid, int startIndex, int goalIndex, std::vector<vec2>& path) {
+	path.clear();
+	if (startIndex == goalIndex) {
+		return true;
+	}
+	// hook start and goal into the abstract graph through their own clusters
+	linkToCluster(grid, startIndex, startLinks);
+	int directCost = -1;
+	if (clusterOf(grid, startIndex) == clusterOf(grid, goalIndex) && cells[goalIndex].closedGeneration == generation) {
+		directCost = cells[goalIndex].g;
+	}
+	linkToCluster(grid, goalIndex, goalLinks);
+
+	if (!abstractSearch(grid, goalIndex, directCost)) {
+		return false;
+	}
+	refine(grid, startIndex, goalIndex, path);
+	return true;
+}
+
+void HierarchicalPathFinder::buildGraph(const NavGrid& grid) {
+	int cellCount = grid.cols * grid.rows;
+	clusterCols = (grid.cols + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+	clusterRows = (grid.rows + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+	findChangedClusters(grid);
+	// node and cluster lists are refilled in place, keeping their capacity between updates
+	for (AbstractNode& node : abstractNodes) {
+		node.edges.clear();
+	}
+	nodeCount = 0;
+	clusterNodes.resize(clusterCols * clusterRows);
+	for (std::vector<int>& nodeIds : clusterNodes) {
+		nodeIds.clear();
+	}
+	cellNode.assign(cellCount, -1);
+
+	// openings across the vertical borders, then across the horizontal ones
+	for (int cy = 0; cy < clusterRows; cy++) {
+		for (int cx = 1; cx < clusterCols; cx++) {
+			int length = min(HPA_CLUSTER_SIZE, grid.rows - cy * HPA_CLUSTER_SIZE);
+			addEntrances(grid, { cx * HPA_CLUSTER_SIZE - 1, cy * HPA_CLUSTER_SIZE }, { 0, 1 }, { 1, 0 }, length);
+		}
+	}
+	for (int cy = 1; cy < clusterRows; cy++) {
+		for (int cx = 0; cx < clusterCols; cx++) {
+			int length = min(HPA_CLUSTER_SIZE, grid.cols - cx * HPA_CLUSTER_SIZE);
+			addEntrances(grid, { cx * HPA_CLUSTER_SIZE, cy * HPA_CLUSTER_SIZE - 1 }, { 1, 0 }, { 0, 1 }, length);
+		}
+	}
+
+	abstractNodes.resize(nodeCount);
+
+	// link the nodes of every cluster by their in-cluster path costs
+	lastRebuiltClusters = 0;
+	for (int cluster = 0; cluster < (int)clusterNodes.size(); cluster++) {
+		linkCluster(grid, cluster);
+	}
+
+	graphVersion = grid.version;
+	graphCols = grid.cols;
+	graphRows = grid.rows;
+}
+
+void HierarchicalPathFinder::findChangedClusters(const NavGrid& grid) {
+	int cellCount = grid.cols * grid.rows;
+	int clusterCount = clusterCols * clusterRows;
+	if (graphCols != grid.cols || graphRows != grid.rows) {
+		clusterLinks.assign(clusterCount, ClusterLinks());
+		changedClusters.assign(clusterCount, 1);
+		builtWalkable.resize(cellCount);
+		for (int i = 0; i < cellCount; i++) {
+			builtWalkable[i] = grid.obstacleCount[i] == 0;
+		}
+		return;
+	}
+	changedClusters.assign(clusterCount, 0);
+	for (int i = 0; i < cellCount; i++) {
+		unsigned char walkable = grid.obstacleCount[i] == 0;
+		if (walkable != builtWalkable[i]) {
+			builtWalkable[i] = walkable;
+			changedClusters[clusterOf(grid, i)] = 1;
+		}
+	}
+}
+
+void HierarchicalPathFinder::linkCluster(const NavGrid& grid, int cluster) {
+	const std::vector<int>& nodeIds = clusterNodes[cluster];
+	ClusterLinks& cached = clusterLinks[cluster];
+	// nodes are added in border scan order, so unchanged openings give the same node cells in the same order
+	bool reuse = !changedClusters[cluster] && cached.nodeCells.size() == nodeIds.size();
+	for (uint slot = 0; reuse && slot < nodeIds.size(); slot++) {
+		reuse = cached.nodeCells[slot] == abstractNodes[nodeIds[slot]].cell;
+	}
+	if (reuse) {
+		for (const ClusterLink& link : cached.links) {
+			abstractNodes[nodeIds[link.from]].edges.push_back({ nodeIds[link.to], link.cost });
+		}
+		return;
+	}
+
+	lastRebuiltClusters++;
+	cached.nodeCells.clear();
+	cached.links.clear();
+	for (int node : nodeIds) {
+		cached.nodeCells.push_back(abstractNodes[node].cell);
+	}
+	for (uint slot = 0; slot < nodeIds.size(); slot++) {
+		boundedSearch(grid, abstractNodes[nodeIds[slot]].cell, -1, cluster);
+		for (uint otherSlot = 0; otherSlot < nodeIds.size(); otherSlot++) {
+			const SearchNode& reached = cells[abstractNodes[nodeIds[otherSlot]].cell];
+			if (otherSlot != slot && reached.closedGeneration == generation) {
+				abstractNodes[nodeIds[slot]].edges.push_back({ nodeIds[otherSlot], reached.g });
+				cached.links.push_back({ (int)slot, (int)otherSlot, reached.g });
+			}
+		}
+	}
+}
+
+void HierarchicalPathFinder::addEntrances(const NavGrid& grid, ivec2 borderStart, ivec2 along, ivec2 across, int length) {
+	int runStart = 0;
+	for (int i = 0; i <= length; i++) {
+		ivec2 inside = borderStart + along * i;
+		bool isOpen = i < length && navCellWalkable(grid, inside) && navCellWalkable(grid, inside + across);
+		if (isOpen) {
+			continue;
+		}
+		// a run of open cell pairs just ended, place its transitions
+		int runLength = i - runStart;
+		if (runLength > 0) {
+			int transitions[2] = { runStart + runLength / 2, -1 };
+			if (runLength > HPA_MAX_SINGLE_TRANSITION) {
+				transitions[0] = runStart;
+				transitions[1] = i - 1;
+			}
+			for (int t : transitions) {
+				if (t < 0) {
+					continue;
+				}
+				ivec2 cell = borderStart + along * t;
+				int a = addNode(grid, navCellIndex(grid, cell));
+				int b = addNode(grid, navCellIndex(grid, cell + across));
+				abstractNodes[a].edges.push_back({ b, NAV_STRAIGHT_COST });
+				abstractNodes[b].edges.push_back({ a, NAV_STRAIGHT_COST });
+			}
+		}
+		runStart = i + 1;
+	}
+}
+
+int HierarchicalPathFinder::addNode(const NavGrid& grid, int cell) {
+	if (cellNode[cell] >= 0) {
+		return cellNode[cell];
+	}
+	if (nodeCount == (int)abstractNodes.size()) {
+		abstractNodes.push_back(AbstractNode());
+	}
+	AbstractNode& node = abstractNodes[nodeCount];
+	node.cell = cell;
+	node.cluster = clusterOf(grid, cell);
+	cellNode[cell] = nodeCount;
+	clusterNodes[node.cluster].push_back(nodeCount);
+	return nodeCount++;
+}
+
+int HierarchicalPathFinder::clusterOf(const NavGrid& grid, int cell) const {
+	ivec2 position = cellPosition(grid, cell);
+	return (position.y / HPA_CLUSTER_SIZE) * clusterCols + position.x / HPA_CLUSTER_SIZE;
+}
+
+unsigned int HierarchicalPathFinder::nextGeneration(std::vector<SearchNode>& scratch, size_t size) {
+	if (scratch.size() != size) {
+		scratch.assign(size, SearchNode());
+	}
+	generation++;
+	// on wrap around old stamps could look current, so reset them once
+	if (generation == 0) {
+		cells.assign(cells.size(), SearchNode());
+		nodes.assign(nodes.size(), SearchNode());
+		generation = 1;
+	}
+	return generation;
+}
+
+bool HierarchicalPathFinder::boundedSearch(const NavGrid& grid, int from, int to, int cluster) {
+	nextGeneration(cells, grid.cols * grid.rows);
+	std::greater<std::pair<int, int>> cheapestFirst;
+	int minX = (cluster % clusterCols) * HPA_CLUSTER_SIZE;
+	int minY = (cluster / clusterCols) * HPA_CLUSTER_SIZE;
+	int maxX = min(minX + HPA_CLUSTER_SIZE, grid.cols) - 1;
+	int maxY = min(minY + HPA_CLUSTER_SIZE, grid.rows) - 1;
+	ivec2 goalCell = to >= 0 ? cellPosition(grid, to) : ivec2(0, 0);
+
+	open.clear();
+	SearchNode& startNode = cells[from];
+	startNode.g = 0;
+	startNode.parent = -1;
+	startNode.openGeneration = generation;
+	open.push_back({ 0, from });
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), cheapestFirst);
+		int currentIndex = open.back().second;
+		open.pop_back();
+		SearchNode& current = cells[currentIndex];
+		// stale heap entry, the cell was already expanded with a cheaper cost
+		if (current.closedGeneration == generation) {
+			continue;
+		}
+		current.closedGeneration = generation;
+		lastLocalExpansions++;
+		if (currentIndex == to) {
+			return true;
+		}
+
+		ivec2 cell = cellPosition(grid, currentIndex);
+		for (const ivec2& offset : NAV_NEIGHBOUR_OFFSETS) {
+			ivec2 nextCell = cell + offset;
+			if (nextCell.x < minX || nextCell.x > maxX || nextCell.y < minY || nextCell.y > maxY) {
+				continue;
+			}
+			if (!navCanStep(grid, cell, offset)) {
+				continue;
+			}
+			int nextIndex = navCellIndex(grid, nextCell);
+			SearchNode& next = cells[nextIndex];
+			if (next.closedGeneration == generation) {
+				continue;
+			}
+			int g = current.g + navStepCost(offset);
+			if (next.openGeneration != generation || g < next.g) {
+				next.g = g;
+				next.parent = currentIndex;
+				next.openGeneration = generation;
+				int h = to >= 0 ? navOctileCost(nextCell, goalCell) : 0;
+				open.push_back({ g + h, nextIndex });
+				std::push_heap(open.begin(), open.end(), cheapestFirst);
+			}
+		}
+	}
+	return to < 0;
+}
+
+void HierarchicalPathFinder::linkToCluster(const NavGrid& grid, int cell, std::vector<std::pair<int, int>>& links) {
+	links.clear();
+	int cluster = clusterOf(grid, cell);
+	boundedSearch(grid, cell, -1, cluster);
+	for (int node : clusterNodes[cluster]) {
+		const SearchNode& reached = cells[abstractNodes[node].cell];
+		if (reached.closedGeneration == generation) {
+			links.push_back({ node, reached.g });
+		}
+	}
+}
+
+bool HierarchicalPathFinder::abstractSearch(const NavGrid& grid, int goalIndex, int directCost) {
+	// the goal is one extra node past the abstract ones
+	int goalNode = (int)abstractNodes.size();
+	nextGeneration(nodes, abstractNodes.size() + 1);
+	std::greater<std::pair<int, int>> cheapestFirst;
+	ivec2 goalCell = cellPosition(grid, goalIndex);
+
+	open.clear();
+	auto relax = [&](int node, int g, int parent) {
+		SearchNode& next = nodes[node];
+		if (next.closedGeneration == generation) {
+			return;
+		}
+		if (next.openGeneration != generation || g < next.g) {
+			next.g = g;
+			next.parent = parent;
+			next.openGeneration = generation;
+			int h = node == goalNode ? 0 : navOctileCost(cellPosition(grid, abstractNodes[node].cell), goalCell);
+			open.push_back({ g + h, node });
+			std::push_heap(open.begin(), open.end(), cheapestFirst);
+		}
+	};
+
+	if (directCost >= 0) {
+		relax(goalNode, directCost, -1);
+	}
+	for (const std::pair<int, int>& link : startLinks) {
+		relax(link.first, link.second, -1);
+	}
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), cheapestFirst);
+		int currentNode = open.back().second;
+		open.pop_back();
+		SearchNode& current = nodes[currentNode];
+		if (current.closedGeneration == generation) {
+			continue;
+		}
+		current.closedGeneration = generation;
+		lastAbstractExpansions++;
+		if (currentNode == goalNode) {
+			abstractPath.clear();
+			for (int node = current.parent; node != -1; node = nodes[node].parent) {
+				abstractPath.push_back(node);
+			}
+			std::reverse(abstractPath.begin(), abstractPath.end());
+			return true;
+		}
+
+		int g = current.g;
+		for (const AbstractEdge& edge : abstractNodes[currentNode].edges) {
+			relax(edge.to, g + edge.cost, currentNode);
+		}
+		for (const std::pair<int, int>& link : goalLinks) {
+			if (link.first == currentNode) {
+				relax(goalNode, g + link.second, currentNode);
+			}
+		}
+	}
+	return false;
+}
+
+void HierarchicalPathFinder::refine(const NavGrid& grid, int startIndex, int goalIndex, std::vector<vec2>& path) {
+	int from = startIndex;
+	for (uint i = 0; i <= abstractPath.size(); i++) {
+		int to = i < abstractPath.size() ? abstractNodes[abstractPath[i]].cell : goalIndex;
+		if (to == from) {
+			continue;
+		}
+		int cluster = clusterOf(grid, from);
+		if (cluster == clusterOf(grid, to)) {
+			// the abstract costs came from this same bounded search, so it cannot fail
+			bool found = boundedSearch(grid, from, to, cluster);
+			assert(found);
+			size_t hopStart = path.size();
+			for (int index = to; index != from; index = cells[index].parent) {
+				path.push_back(navCellCenter(grid, cellPosition(grid, index)));
+			}
+			std::reverse(path.begin() + hopStart, path.end());
+		}
+		else {
+			// crossing into the neighbouring cluster is a single straight step
+			path.push_back(navCellCenter(grid, cellPosition(grid, to)));
+		}
+		from = to;
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+// stlib
+#include <vector>
+
+#include "common.hpp"
+#include "nav_grid.hpp"
+
+// Side of one cluster, in nav cells
+const int HPA_CLUSTER_SIZE = 16;
+// Openings wider than this get a transition at both ends instead of one in the middle
+const int HPA_MAX_SINGLE_TRANSITION = 6;
+// Below this many cells a flat A* is cheaper than keeping the abstract graph up to date
+const int HPA_MIN_GRID_CELLS = 64 * 64;
+
+// Large arenas path through the hierarchy, the single screen levels keep the flat search
+inline bool useHierarchicalSearch(const NavGrid& grid) {
+	return grid.cols * grid.rows >= HPA_MIN_GRID_CELLS;
+}
+
+// HPA* over the nav grid. The grid is cut into clusters, the walkable openings between neighbouring
+// clusters become abstract nodes, and nodes of a cluster are linked by their in-cluster path costs.
+// A query searches the small abstract graph, then refines every hop with an A* bounded to one cluster.
+// When the grid version changes the cluster borders are rescanned for openings, which is cheap, but the
+// in-cluster links are only searched again in clusters whose cells or openings changed, so a door or
+// an obstacle only costs the clusters it touches
+class HierarchicalPathFinder
+{
+public:
+	// Same contract as GridPathFinder::findPath: cell centres from the cell after start up to goal,
+	// false (and path left empty) when the goal cannot be reached
+	bool findPath(const NavGrid& grid, vec2 start, vec2 goal, std::vector<vec2>& path);
+	// Rebuilds the abstract graph if the grid changed since, findPath calls it as well
+	void prepare(const NavGrid& grid);
+
+	// Stats of the last query, for profiling
+	int lastAbstractExpansions = 0;
+	int lastLocalExpansions = 0;
+	size_t getAbstractNodeCount() const { return abstractNodes.size(); };
+	// Clusters whose in-cluster links were searched again by the last graph update, for profiling
+	int lastRebuiltClusters = 0;
+
+private:
+	struct AbstractEdge {
+		int to;
+		int cost;
+	};
+	struct AbstractNode {
+		int cell;
+		int cluster;
+		std::vector<AbstractEdge> edges;
+	};
+	std::vector<AbstractNode> abstractNodes;
+	// nodes placed so far while the borders are scanned, slots past it are reused from the last update
+	int nodeCount = 0;
+	// abstract nodes inside each cluster
+	std::vector<std::vector<int>> clusterNodes;
+	// abstract node of each cell, -1 for plain cells
+	std::vector<int> cellNode;
+	int clusterCols = 0;
+	int clusterRows = 0;
+	unsigned int graphVersion = 0;
+	int graphCols = -1;
+	int graphRows = -1;
+
+	// In-cluster links of a cluster from the last update, between slots of nodeCells. They are reused
+	// as long as neither the cluster's cells nor the cells of its abstract nodes changed
+	struct ClusterLink {
+		int from;
+		int to;
+		int cost;
+	};
+	struct ClusterLinks {
+		std::vector<int> nodeCells;
+		std::vector<ClusterLink> links;
+	};
+	std::vector<ClusterLinks> clusterLinks;
+	// walkability the graph was built from, compared with the grid to find the clusters that changed
+	std::vector<unsigned char> builtWalkable;
+	std::vector<unsigned char> changedClusters;
+
+	// Scratch shared by the cell and the abstract searches, stamped with a per-search generation
+	// like GridPathFinder so nothing is cleared between searches
+	struct SearchNode {
+		int g = 0;
+		int parent = -1;
+		unsigned int openGeneration = 0;
+		unsigned int closedGeneration = 0;
+	};
+	std::vector<SearchNode> cells;
+	std::vector<SearchNode> nodes;
+	unsigned int generation = 0;
+	// (f, index) min-heap
+	std::vector<std::pair<int, int>> open;
+	// open cells the query starts from and ends in, more than one when the start or goal is blocked
+	std::vector<int> startCandidates;
+	std::vector<int> goalCandidates;
+	// in-cluster costs from the query start and to the query goal, per abstract node of that cluster
+	std::vector<std::pair<int, int>> startLinks;
+	std::vector<std::pair<int, int>> goalLinks;
+	std::vector<int> abstractPath;
+
+	void buildGraph(const NavGrid& grid);
+	// Flags the clusters with a cell whose walkability changed since the last update, all of them on a resize
+	void findChangedClusters(const NavGrid& grid);
+	void linkCluster(const NavGrid& grid, int cluster);
+	void addEntrances(const NavGrid& grid, ivec2 borderStart, ivec2 along, ivec2 across, int length);
+	int addNode(const NavGrid& grid, int cell);
+	int clusterOf(const NavGrid& grid, int cell) const;
+	unsigned int nextGeneration(std::vector<SearchNode>& scratch, size_t size);
+	// A* from one cell to another (Dijkstra over the whole cluster when to is -1) without leaving the cluster
+	bool boundedSearch(const NavGrid& grid, int from, int to, int cluster);
+	// in-cluster cost from cell to every abstract node of its cluster it can reach
+	void linkToCluster(const NavGrid& grid, int cell, std::vector<std::pair<int, int>>& links);
+	void openNeighbours(const NavGrid& grid, ivec2 cell, ivec2 towards, bool leaving, std::vector<int>& candidates);
+	bool searchBetween(const NavGrid& grid, int startIndex, int goalIndex, std::vector<vec2>& path);
+	bool abstractSearch(const NavGrid& grid, int goalIndex, int directCost);
+	void refine(const NavGrid& grid, int startIndex, int goalIndex, std::vector<vec2>& path);
+};
@@ -0,0 +1,105 @@
+// internal
+#include "image_decoder.hpp"
+
+#include "../ext/stb_image/stb_image.h"
+
+// stlib
+#include <algorithm>
+#include <chrono>
+
+ImageDecoder::~ImageDecoder() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quitting = true;
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	// decoded but never collected, e.g. when the game quits during startup
+	for (Job& job : jobs) {
+		if (job.state == JOB_STATE::DONE && job.image.pixels != nullptr) {
+			stbi_image_free(job.image.pixels);
+		}
+	}
+}
+
+void ImageDecoder::start(const std::vector<std::string>& paths, int threadCount) {
+	assert(jobs.empty() && "ImageDecoder can only be started once");
+	jobs.resize(paths.size());
+	for (size_t i = 0; i < paths.size(); i++) {
+		jobs[i].path = paths[i];
+	}
+	untaken = (int)jobs.size();
+	// at least one thread, the caller is busy uploading
+	int count = std::max(1, std::min(threadCount, (int)jobs.size()));
+	for (int i = 0; i < count; i++) {
+		threads.emplace_back(&ImageDecoder::workerLoop, this);
+	}
+}
+
+DecodedImage ImageDecoder::decode(const std::string& path) {
+	auto start = std::chrono::high_resolution_clock::now();
+	DecodedImage image;
+	image.pixels = stbi_load(path.c_str(), &image.size.x, &image.size.y, NULL, 4);
+	image.decodeMs = (float)(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start)).count() / 1000;
+	return image;
+}
+
+void ImageDecoder::workerLoop() {
+	while (true) {
+		size_t job;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			// wait may have claimed jobs out of order
+			while (nextPending < jobs.size() && jobs[nextPending].state != JOB_STATE::PENDING) {
+				nextPending++;
+			}
+			if (quitting || nextPending == jobs.size()) {
+				return;
+			}
+			job = nextPending++;
+			jobs[job].state = JOB_STATE::DECODING;
+		}
+		DecodedImage image = decode(jobs[job].path);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs[job].image = image;
+			jobs[job].state = JOB_STATE::DONE;
+		}
+		decoded.notify_all();
+	}
+}
+
+bool ImageDecoder::poll(int& job, DecodedImage& image) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t i = 0; i < jobs.size(); i++) {
+		if (jobs[i].state == JOB_STATE::DONE) {
+			jobs[i].state = JOB_STATE::TAKEN;
+			untaken--;
+			job = (int)i;
+			image = jobs[i].image;
+			return true;
+		}
+	}
+	return false;
+}
+
+DecodedImage ImageDecoder::wait(int job) {
+	std::unique_lock<std::mutex> lock(mutex);
+	Job& waited = jobs[job];
+	assert(waited.state != JOB_STATE::TAKEN && "Job was already handed out");
+	untaken--;
+	if (waited.state == JOB_STATE::PENDING) {
+		waited.state = JOB_STATE::TAKEN;
+		lock.unlock();
+		return decode(waited.path);
+	}
+	decoded.wait(lock, [&]() { return waited.state == JOB_STATE::DONE; });
+	waited.state = JOB_STATE::TAKEN;
+	return waited.image;
+}
+
+int ImageDecoder::remaining() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return untaken;
+}
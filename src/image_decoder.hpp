@@ -0,0 +1,62 @@
+#pragma once
+
+// stlib
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common.hpp"
+#include "worker_pool.hpp"
+
+// One decoded file, RGBA8 rows in file order. The receiver owns pixels and frees them with
+// stbi_image_free, pixels is null when the file could not be read
+struct DecodedImage {
+	unsigned char* pixels = nullptr;
+	ivec2 size = { 0, 0 };
+	float decodeMs = 0.f;
+};
+
+// Decodes image files on its own threads, in the order they were queued, while the caller goes on.
+// The GL thread collects finished images with poll, or waits for one it cannot do without.
+// Every job is handed out exactly once, by poll or by wait
+class ImageDecoder
+{
+public:
+	~ImageDecoder();
+
+	// Queues the files, most urgent first, and starts decoding. Job ids are indices into paths
+	void start(const std::vector<std::string>& paths, int threadCount = WorkerPool::defaultThreadCount());
+	// A decoded job not handed out yet, false if none is ready
+	bool poll(int& job, DecodedImage& image);
+	// Blocks until job is decoded. A job no thread has started is decoded on the caller
+	DecodedImage wait(int job);
+	// Jobs not handed out yet
+	int remaining();
+
+private:
+	enum class JOB_STATE {
+		PENDING = 0,
+		DECODING = PENDING + 1,
+		DONE = DECODING + 1,
+		TAKEN = DONE + 1
+	};
+	struct Job {
+		std::string path;
+		JOB_STATE state = JOB_STATE::PENDING;
+		DecodedImage image;
+	};
+	// sized once by start, so workers read paths without the lock
+	std::vector<Job> jobs;
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable decoded;
+	// jobs before it have all been claimed
+	size_t nextPending = 0;
+	int untaken = 0;
+	bool quitting = false;
+
+	void workerLoop();
+	static DecodedImage decode(const std::string& path);
+};
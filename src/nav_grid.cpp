@@ -0,0 +1,83 @@
+// internal
+#include "nav_grid.hpp"
+
+// Adds delta to every cell whose centre lies inside the obstacle grown by the agent radius
+static void stampObstacle(NavGrid& grid, const Motion& motion, int delta) {
+	vec2 halfExtent = abs(motion.scale) / 2.f + vec2(grid.agentRadius);
+	vec2 minCorner = (motion.position - halfExtent) / grid.cellSize - 0.5f;
+	vec2 maxCorner = (motion.position + halfExtent) / grid.cellSize - 0.5f;
+	int minX = max((int)ceil(minCorner.x), 0);
+	int minY = max((int)ceil(minCorner.y), 0);
+	int maxX = min((int)floor(maxCorner.x), grid.cols - 1);
+	int maxY = min((int)floor(maxCorner.y), grid.rows - 1);
+	for (int y = minY; y <= maxY; y++) {
+		for (int x = minX; x <= maxX; x++) {
+			int& count = grid.obstacleCount[navCellIndex(grid, { x, y })];
+			count = max(count + delta, 0);
+		}
+	}
+	grid.version++;
+}
+
+NavGrid& buildNavGrid(vec2 worldSize, float cellSize, float agentRadius) {
+	if (registry.navGrids.size() == 0) {
+		registry.navGrids.emplace(Entity());
+	}
+	NavGrid& grid = registry.navGrids.components[0];
+	grid.cellSize = cellSize;
+	grid.agentRadius = agentRadius;
+	grid.cols = max((int)ceil(worldSize.x / cellSize), 1);
+	grid.rows = max((int)ceil(worldSize.y / cellSize), 1);
+	grid.obstacleCount.assign(grid.cols * grid.rows, 0);
+
+	for (Entity block : registry.blocks.entities) {
+		stampObstacle(grid, registry.motions.get(block), 1);
+	}
+	for (Entity wall : registry.walls.entities) {
+		stampObstacle(grid, registry.motions.get(wall), 1);
+	}
+	grid.version++;
+	return grid;
+}
+
+void invalidateNavGrid() {
+	if (registry.navGrids.size() > 0) {
+		// keep the version so caches built on the old grid still see the rebuild as a change
+		NavGrid& grid = registry.navGrids.components[0];
+		grid.cols = 0;
+		grid.rows = 0;
+		grid.obstacleCount.clear();
+		grid.version++;
+	}
+}
+
+void addNavObstacle(const Motion& motion) {
+	if (hasNavGrid()) {
+		stampObstacle(registry.navGrids.components[0], motion, 1);
+	}
+}
+
+void removeNavObstacle(const Motion& motion) {
+	if (hasNavGrid()) {
+		stampObstacle(registry.navGrids.components[0], motion, -1);
+	}
+}
+
+bool hasNavGrid() {
+	return registry.navGrids.size() > 0 && registry.navGrids.components[0].cols > 0;
+}
+
+const NavGrid& getNavGrid() {
+	assert(hasNavGrid());
+	return registry.navGrids.components[0];
+}
+
+ivec2 navCellOf(const NavGrid& grid, vec2 position) {
+	int x = (int)floor(position.x / grid.cellSize);
+	int y = (int)floor(position.y / grid.cellSize);
+	return { clamp(x, 0, grid.cols - 1), clamp(y, 0, grid.rows - 1) };
+}
+
+vec2 navCellCenter(const NavGrid& grid, ivec2 cell) {
+	return (vec2(cell) + 0.5f) * grid.cellSize;
+}
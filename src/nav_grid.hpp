@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// Defaults in unscaled pixels, callers multiply them by defaultResolution.scaling
+const float NAV_CELL_SIZE = 40.f;
+const float NAV_AGENT_RADIUS = 30.f;
+
+// (Re)builds the level nav grid covering worldSize from every block and wall (the door is a wall)
+NavGrid& buildNavGrid(vec2 worldSize, float cellSize, float agentRadius);
+// Drops the grid while a level's geometry is torn down and rebuilt, until the next buildNavGrid
+void invalidateNavGrid();
+// Incremental updates for geometry added or removed after the grid was built, no-ops while it is invalid
+void addNavObstacle(const Motion& motion);
+void removeNavObstacle(const Motion& motion);
+
+bool hasNavGrid();
+const NavGrid& getNavGrid();
+
+inline bool navCellInBounds(const NavGrid& grid, ivec2 cell) {
+	return cell.x >= 0 && cell.y >= 0 && cell.x < grid.cols && cell.y < grid.rows;
+}
+
+inline int navCellIndex(const NavGrid& grid, ivec2 cell) {
+	return cell.y * grid.cols + cell.x;
+}
+
+inline bool navCellWalkable(const NavGrid& grid, ivec2 cell) {
+	return navCellInBounds(grid, cell) && grid.obstacleCount[navCellIndex(grid, cell)] == 0;
+}
+
+// Octile step costs and the 8-connected neighbourhood used by every grid search
+const int NAV_STRAIGHT_COST = 10;
+const int NAV_DIAGONAL_COST = 14;
+const ivec2 NAV_NEIGHBOUR_OFFSETS[8] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+inline int navStepCost(ivec2 offset) {
+	return (offset.x != 0 && offset.y != 0) ? NAV_DIAGONAL_COST : NAV_STRAIGHT_COST;
+}
+
+// Cost of the cheapest unobstructed route between two cells, the A* heuristic
+inline int navOctileCost(ivec2 from, ivec2 to) {
+	int dx = abs(from.x - to.x);
+	int dy = abs(from.y - to.y);
+	return NAV_STRAIGHT_COST * (dx + dy) + (NAV_DIAGONAL_COST - 2 * NAV_STRAIGHT_COST) * min(dx, dy);
+}
+
+// Diagonal moves need both sides open so agents do not cut corners
+inline bool navCanStep(const NavGrid& grid, ivec2 from, ivec2 offset) {
+	if (!navCellWalkable(grid, from + offset)) {
+		return false;
+	}
+	if (offset.x != 0 && offset.y != 0) {
+		return navCellWalkable(grid, { from.x + offset.x, from.y }) && navCellWalkable(grid, { from.x, from.y + offset.y });
+	}
+	return true;
+}
+
+// Cell containing a world position, clamped to the grid
+ivec2 navCellOf(const NavGrid& grid, vec2 position);
+vec2 navCellCenter(const NavGrid& grid, ivec2 cell);
@@ -0,0 +1,58 @@
+#pragma once
+
+// stlib
+#include <vector>
+#include <type_traits>
+
+#include "common.hpp"
+
+// Turning points an agent keeps. The rest of a longer path is dropped, and the agent plans again
+// once it has walked the part it kept
+const int PATH_BUFFER_CAPACITY = 32;
+
+// Fixed-capacity path stored inline in a component. It never allocates, and the component stays
+// trivially copyable, so the swap-and-pop removal of the ECS containers is a plain memcpy
+struct PathBuffer
+{
+	vec2 points[PATH_BUFFER_CAPACITY];
+	// points before head have been walked already
+	unsigned short head = 0;
+	unsigned short count = 0;
+	// the source path had more turning points than fit
+	bool truncated = false;
+
+	bool empty() const { return head == count; };
+	int size() const { return count - head; };
+	const vec2& front() const {
+		assert(!empty());
+		return points[head];
+	};
+	void pop() {
+		assert(!empty());
+		head++;
+	};
+	void clear() {
+		head = 0;
+		count = 0;
+		truncated = false;
+	};
+	void push(vec2 point) {
+		if (count == PATH_BUFFER_CAPACITY) {
+			truncated = true;
+			return;
+		}
+		points[count++] = point;
+	};
+
+	// Keeps only the cells of a grid path where it turns, the agent walks straight in between
+	void assignTurningPoints(const std::vector<vec2>& path) {
+		clear();
+		for (size_t i = 0; i < path.size() && !truncated; i++) {
+			bool isLast = i + 1 == path.size();
+			if (isLast || i == 0 || path[i + 1] - path[i] != path[i] - path[i - 1]) {
+				push(path[i]);
+			}
+		}
+	};
+};
+static_assert(std::is_trivially_copyable<PathBuffer>::value, "PathBuffer must stay memcpy-able");
@@ -0,0 +1,208 @@
+// internal
+#include "path_finder.hpp"
+
+// stlib
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <functional>
+
+using Clock = std::chrono::high_resolution_clock;
+
+const size_t MAX_CACHED_PATHS = 256;
+// expansions between two budget checks, keeps clock reads off the hot loop
+const int EXPANSIONS_PER_SLICE = 32;
+
+bool GridPathFinder::findPath(const NavGrid& grid, vec2 start, vec2 goal, std::vector<vec2>& path) {
+	PATH_SEARCH_STATE state = beginSearch(grid, start, goal);
+	while (state == PATH_SEARCH_STATE::RUNNING) {
+		state = continueSearch(grid, INT_MAX);
+	}
+	if (state == PATH_SEARCH_STATE::FOUND) {
+		path = resultPath;
+		return true;
+	}
+	path.clear();
+	return false;
+}
+
+unsigned long long GridPathFinder::cacheKey() const {
+	return ((unsigned long long)startIndex << 32) | (unsigned int)goalIndex;
+}
+
+PATH_SEARCH_STATE GridPathFinder::beginSearch(const NavGrid& grid, vec2 start, vec2 goal) {
+	lastIterations = 0;
+	lastWasCached = false;
+	startIndex = navCellIndex(grid, navCellOf(grid, start));
+	goalIndex = navCellIndex(grid, navCellOf(grid, goal));
+	int cellCount = grid.cols * grid.rows;
+
+	if (cacheGridVersion != grid.version || cacheGridCells != cellCount) {
+		cache.clear();
+		cacheGridVersion = grid.version;
+		cacheGridCells = cellCount;
+	}
+	auto cached = cache.find(cacheKey());
+	if (cached != cache.end()) {
+		resultPath = cached->second;
+		lastWasCached = true;
+		return PATH_SEARCH_STATE::FOUND;
+	}
+
+	if ((int)nodes.size() != cellCount) {
+		nodes.assign(cellCount, Node());
+		generation = 0;
+	}
+	generation++;
+	// on wrap around old stamps could look current, so reset them once
+	if (generation == 0) {
+		nodes.assign(cellCount, Node());
+		generation = 1;
+	}
+
+	open.clear();
+	Node& startNode = nodes[startIndex];
+	startNode.g = 0;
+	startNode.parent = -1;
+	startNode.openGeneration = generation;
+	ivec2 startCell = { startIndex % grid.cols, startIndex / grid.cols };
+	ivec2 goalCell = { goalIndex % grid.cols, goalIndex / grid.cols };
+	open.push_back({ navOctileCost(startCell, goalCell), startIndex });
+	return PATH_SEARCH_STATE::RUNNING;
+}
+
+PATH_SEARCH_STATE GridPathFinder::continueSearch(const NavGrid& grid, int maxExpansions) {
+	std::greater<std::pair<int, int>> cheapestFirst;
+	ivec2 goalCell = { goalIndex % grid.cols, goalIndex / grid.cols };
+	int expansions = 0;
+	while (!open.empty() && lastIterations < maxIterations) {
+		if (expansions >= maxExpansions) {
+			return PATH_SEARCH_STATE::RUNNING;
+		}
+		std::pop_heap(open.begin(), open.end(), cheapestFirst);
+		int currentIndex = open.back().second;
+		open.pop_back();
+		Node& current = nodes[currentIndex];
+		// stale heap entry, the cell was already expanded with a cheaper cost
+		if (current.closedGeneration == generation) {
+			continue;
+		}
+		current.closedGeneration = generation;
+		lastIterations++;
+		expansions++;
+		if (currentIndex == goalIndex) {
+			buildPath(grid);
+			if (cache.size() >= MAX_CACHED_PATHS) {
+				cache.clear();
+			}
+			cache[cacheKey()] = resultPath;
+			return PATH_SEARCH_STATE::FOUND;
+		}
+
+		ivec2 cell = { currentIndex % grid.cols, currentIndex / grid.cols };
+		for (const ivec2& offset : NAV_NEIGHBOUR_OFFSETS) {
+			ivec2 nextCell = cell + offset;
+			if (!navCellInBounds(grid, nextCell)) {
+				continue;
+			}
+			int nextIndex = navCellIndex(grid, nextCell);
+			// the goal is accepted even when the target hugs an obstacle
+			if (nextIndex != goalIndex && !navCanStep(grid, cell, offset)) {
+				continue;
+			}
+			Node& next = nodes[nextIndex];
+			if (next.closedGeneration == generation) {
+				continue;
+			}
+			int g = current.g + navStepCost(offset);
+			if (next.openGeneration != generation || g < next.g) {
+				next.g = g;
+				next.parent = currentIndex;
+				next.openGeneration = generation;
+				open.push_back({ g + navOctileCost(nextCell, goalCell), nextIndex });
+				std::push_heap(open.begin(), open.end(), cheapestFirst);
+			}
+		}
+	}
+	return PATH_SEARCH_STATE::FAILED;
+}
+
+void GridPathFinder::buildPath(const NavGrid& grid) {
+	resultPath.clear();
+	for (int index = goalIndex; index != startIndex; index = nodes[index].parent) {
+		resultPath.push_back(navCellCenter(grid, { index % grid.cols, index / grid.cols }));
+	}
+	std::reverse(resultPath.begin(), resultPath.end());
+}
+
+void PathRequestQueue::request(Entity agent, vec2 start, vec2 goal) {
+	// the front request may already be half searched, later ones are just updated in place.
+	// A new goal for the agent being searched queues a follow-up, whose path replaces the stale one
+	for (uint i = searchInProgress ? 1 : 0; i < pending.size(); i++) {
+		if (pending[i].agent == agent) {
+			pending[i].start = start;
+			pending[i].goal = goal;
+			return;
+		}
+	}
+	pending.push_back({ agent, start, goal });
+}
+
+void PathRequestQueue::process(const NavGrid& grid) {
+	// build the abstract graph as soon as a new level's grid shows up, not on its first request
+	if (useHierarchicalSearch(grid)) {
+		hierarchicalFinder.prepare(grid);
+	}
+	auto startTime = Clock::now();
+	while (!pending.empty()) {
+		PathRequest& front = pending.front();
+		if (useHierarchicalSearch(grid)) {
+			PathResult result;
+			result.agent = front.agent;
+			result.found = hierarchicalFinder.findPath(grid, front.start, front.goal, hierarchicalPath);
+			result.path.assignTurningPoints(hierarchicalPath);
+			completed.push_back(result);
+			pending.pop_front();
+			searchInProgress = false;
+		}
+		else {
+			processFlatRequest(grid, front);
+		}
+
+		float elapsedMicroseconds = (float)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime).count();
+		if (elapsedMicroseconds >= budgetMicroseconds) {
+			break;
+		}
+	}
+}
+
+void PathRequestQueue::processFlatRequest(const NavGrid& grid, PathRequest& front) {
+	PATH_SEARCH_STATE state;
+	// geometry changed under a partial search, start it again on the new grid
+	if (!searchInProgress || searchGridVersion != grid.version) {
+		state = finder.beginSearch(grid, front.start, front.goal);
+		searchInProgress = true;
+		searchGridVersion = grid.version;
+	}
+	else {
+		state = finder.continueSearch(grid, EXPANSIONS_PER_SLICE);
+	}
+
+	if (state != PATH_SEARCH_STATE::RUNNING) {
+		PathResult result;
+		result.agent = front.agent;
+		result.found = state == PATH_SEARCH_STATE::FOUND;
+		if (result.found) {
+			result.path.assignTurningPoints(finder.getPath());
+		}
+		completed.push_back(result);
+		pending.pop_front();
+		searchInProgress = false;
+	}
+}
+
+void PathRequestQueue::clear() {
+	pending.clear();
+	completed.clear();
+	searchInProgress = false;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+// stlib
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+#include "common.hpp"
+#include "nav_grid.hpp"
+#include "hierarchical_path.hpp"
+#include "path_buffer.hpp"
+
+enum class PATH_SEARCH_STATE {
+	RUNNING = 0,
+	FOUND = RUNNING + 1,
+	FAILED = FOUND + 1
+};
+
+// Grid A* over the nav grid. Node scratch space is sized once per grid and reused, open and
+// closed membership is stamped with a per-search generation so nothing is cleared between queries
+class GridPathFinder
+{
+public:
+	// Upper bound on expanded cells per query, a goal that cannot be reached costs at most this much
+	int maxIterations = 4096;
+
+	// Runs a whole query at once. Fills path with the cell centres from the cell after start up to goal,
+	// returns false (and leaves path empty) when the goal cannot be reached within maxIterations
+	bool findPath(const NavGrid& grid, vec2 start, vec2 goal, std::vector<vec2>& path);
+
+	// Resumable queries: beginSearch, then continueSearch until it stops returning RUNNING.
+	// Only one search can be in progress at a time
+	PATH_SEARCH_STATE beginSearch(const NavGrid& grid, vec2 start, vec2 goal);
+	PATH_SEARCH_STATE continueSearch(const NavGrid& grid, int maxExpansions);
+	// Result of the last search that returned FOUND
+	const std::vector<vec2>& getPath() const { return resultPath; };
+
+	// Stats of the last query, for profiling
+	int lastIterations = 0;
+	bool lastWasCached = false;
+
+private:
+	struct Node {
+		int g = 0;
+		int parent = -1;
+		unsigned int openGeneration = 0;
+		unsigned int closedGeneration = 0;
+	};
+	std::vector<Node> nodes;
+	// (f, cell index) min-heap
+	std::vector<std::pair<int, int>> open;
+	unsigned int generation = 0;
+	int startIndex = -1;
+	int goalIndex = -1;
+	std::vector<vec2> resultPath;
+
+	// Paths keyed by (start cell, goal cell), dropped whenever the grid changes
+	std::unordered_map<unsigned long long, std::vector<vec2>> cache;
+	unsigned int cacheGridVersion = 0;
+	int cacheGridCells = 0;
+
+	unsigned long long cacheKey() const;
+	void buildPath(const NavGrid& grid);
+};
+
+// Agents submit path requests here instead of searching inline. process() works through them
+// under a per-frame time budget and resumes a partially searched request on the next frame.
+// Grids big enough for useHierarchicalSearch go through the HPA* finder instead
+class PathRequestQueue
+{
+public:
+	float budgetMicroseconds = 500.f;
+
+	struct PathResult {
+		Entity agent;
+		bool found = false;
+		// turning points only, ready to be copied into the agent's component
+		PathBuffer path;
+	};
+	// Filled by process(), the caller consumes and clears it
+	std::vector<PathResult> completed;
+
+	// A newer request from an agent replaces its pending one, or follows it when its search has started
+	void request(Entity agent, vec2 start, vec2 goal);
+	void process(const NavGrid& grid);
+	void clear();
+	size_t pendingCount() const { return pending.size(); };
+
+private:
+	struct PathRequest {
+		Entity agent;
+		vec2 start;
+		vec2 goal;
+	};
+	std::deque<PathRequest> pending;
+	GridPathFinder finder;
+	// large arenas, each request is solved whole since a hierarchical query is cheap
+	HierarchicalPathFinder hierarchicalFinder;
+	// cell path of the last hierarchical query, reused between requests
+	std::vector<vec2> hierarchicalPath;
+	// the front request has a search in progress in finder
+	bool searchInProgress = false;
+	unsigned int searchGridVersion = 0;
+
+	// one budget slice of the front request on the flat finder
+	void processFlatRequest(const NavGrid& grid, PathRequest& front);
+};
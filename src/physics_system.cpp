@@ -14,6 +14,24 @@ bool inline checkIfFundsArePresent(int playerMoney, int cost) {
 	return (playerMoney - cost) >= 0;
 }
 
+void PhysicsSystem::initializeCollisionHandlers() {
+	// Pairs without a handler are ignored
+	for (auto& row : collision_handlers) {
+		row.fill(nullptr);
+	}
+	collision_handlers[(int)COLLIDER_CATEGORY::PROJECTILE][(int)COLLIDER_CATEGORY::ENEMY] = &PhysicsSystem::projectileHitsEnemy;
+	collision_handlers[(int)COLLIDER_CATEGORY::SWORD][(int)COLLIDER_CATEGORY::ENEMY] = &PhysicsSystem::swordHitsEnemy;
+	collision_handlers[(int)COLLIDER_CATEGORY::PLAYER][(int)COLLIDER_CATEGORY::POWERUP] = &PhysicsSystem::playerTouchesPowerup;
+	collision_handlers[(int)COLLIDER_CATEGORY::PLAYER][(int)COLLIDER_CATEGORY::ENEMY] = &PhysicsSystem::playerTouchesEnemy;
+	collision_handlers[(int)COLLIDER_CATEGORY::PLAYER][(int)COLLIDER_CATEGORY::ENEMY_PROJECTILE] = &PhysicsSystem::playerHitByEnemyProjectile;
+}
+
+// Entities without a Collider, or removed by an earlier response this step, take no part in the dispatch
+static COLLIDER_CATEGORY colliderCategory(Entity entity) {
+	Collider* collider = registry.colliders.find(entity);
+	return collider ? collider->category : COLLIDER_CATEGORY::NONE;
+}
+
 void PhysicsSystem::handle_collision() {
 	// Loop over all collisions detected by the physics system
 	auto& collisionsRegistry = registry.collisions;
@@ -22,65 +40,72 @@ void PhysicsSystem::handle_collision() {
 		Entity entity = collisionsRegistry.entities[i];
 		Entity entity_other = collisionsRegistry.components[i].other;
 
-		// Checking collision of projectiles with other entities (enemies or enemies run)
-		if (registry.projectiles.has(entity)) {
-			if (registry.enemies.has(entity_other) && !registry.enemies.get(entity_other).isDead) {
-				Entity playerEntity = registry.projectiles.get(entity).belongToPlayer;
-				Motion& projectileMotion = registry.motions.get(entity);
-				enemyHitStatUpdate(entity_other, playerEntity, projectileMotion.velocity);
-				registry.remove_all_components_of(entity);
-			}
+		// Categories are looked up per contact since an earlier response may have removed either entity
+		CollisionHandler handler = collision_handlers[(int)colliderCategory(entity)][(int)colliderCategory(entity_other)];
+		if (handler) {
+			(this->*handler)(entity, entity_other);
 		}
+	}
 
-		if (registry.swords.has(entity)) {
-			if (registry.enemies.has(entity_other) && !registry.enemies.get(entity_other).isDead) {
-				Entity playerEntity = registry.swords.get(entity).belongToPlayer;
-				enemyHitStatUpdate(entity_other, playerEntity, vec2(0, 0));
-			}
-		}
+	// Remove all collisions from this simulation step
+	registry.collisions.clear();
+}
 
-		if (registry.powerups.has(entity)) {
-			if (registry.players.has(entity_other)) {
-				//Deduct if money is available
-				Player& playerCom = registry.players.get(entity_other);
-				PlayerStat& playerStatCom = registry.playerStats.get(playerCom.playerStat);
-				bool isPlayerOne = entity_other.getId() == registry.players.entities.front().getId();
-				bool isPlayerTwo = entity_other.getId() == registry.players.entities.back().getId();
-				// Check if player can afford powerup 
-				int powerUpCost = registry.powerups.get(entity).cost; 
-				if (checkIfFundsArePresent(playerStatCom.money, powerUpCost)) {
-					handlePowerUpCollisions(playerCom, playerStatCom, entity, isPlayerOne, isPlayerTwo, powerUpCost);
-				}
-				if (entity_other.getId() == registry.players.entities.front()) {
-					updateHudCoin(KNIGHT);
-				}
-				else {
-					updateHudCoin(WIZARD);
-				}
-			}
-		}
+void PhysicsSystem::projectileHitsEnemy(Entity projectile, Entity enemy) {
+	if (!registry.enemies.get(enemy).isDead) {
+		Entity playerEntity = registry.projectiles.get(projectile).belongToPlayer;
+		Motion& projectileMotion = registry.motions.get(projectile);
+		enemyHitStatUpdate(enemy, playerEntity, projectileMotion.velocity);
+		registry.remove_all_components_of(projectile);
+	}
+}
 
-		if (registry.players.has(entity) && !registry.players.get(entity).isDead) {
-			// Check Player - Enemy collisions 
-			bool enemyConditionCheck = registry.enemies.has(entity_other) && !registry.enemies.get(entity_other).isDead
-				&& !registry.enemiesTutorial.has(entity_other) && !registry.enemyBoss.has(entity_other); 
-			if (enemyConditionCheck) {
-				int enemyDamage = registry.enemies.get(entity_other).damage;
-				resolvePlayerDamage(entity, enemyDamage);
-			}
-			else if (registry.enemyProjectiles.has(entity_other)) {
-				Entity enemyEntity = registry.enemyProjectiles.get(entity_other).belongToEnemy;
-				if (registry.enemies.has(enemyEntity)) {
-					int enemyDamage = registry.enemies.get(enemyEntity).damage;
-					resolvePlayerDamage(entity, enemyDamage);
-					registry.remove_all_components_of(entity_other);
-				}
-			}
-		}
+void PhysicsSystem::swordHitsEnemy(Entity sword, Entity enemy) {
+	if (!registry.enemies.get(enemy).isDead) {
+		Entity playerEntity = registry.swords.get(sword).belongToPlayer;
+		enemyHitStatUpdate(enemy, playerEntity, vec2(0, 0));
 	}
+}
 
-	// Remove all collisions from this simulation step
-	registry.collisions.clear();
+void PhysicsSystem::playerTouchesPowerup(Entity player, Entity powerup) {
+	//Deduct if money is available
+	Player& playerCom = registry.players.get(player);
+	PlayerStat& playerStatCom = registry.playerStats.get(playerCom.playerStat);
+	bool isPlayerOne = player.getId() == registry.players.entities.front().getId();
+	bool isPlayerTwo = player.getId() == registry.players.entities.back().getId();
+	// Check if player can afford powerup 
+	int powerUpCost = registry.powerups.get(powerup).cost; 
+	if (checkIfFundsArePresent(playerStatCom.money, powerUpCost)) {
+		handlePowerUpCollisions(playerCom, playerStatCom, powerup, isPlayerOne, isPlayerTwo, powerUpCost);
+	}
+	if (isPlayerOne) {
+		updateHudCoin(KNIGHT);
+	}
+	else {
+		updateHudCoin(WIZARD);
+	}
+}
+
+void PhysicsSystem::playerTouchesEnemy(Entity player, Entity enemy) {
+	// Tutorial enemies and the boss body do not hurt on contact
+	bool enemyConditionCheck = !registry.players.get(player).isDead && !registry.enemies.get(enemy).isDead
+		&& !registry.enemiesTutorial.has(enemy) && !registry.enemyBoss.has(enemy); 
+	if (enemyConditionCheck) {
+		int enemyDamage = registry.enemies.get(enemy).damage;
+		resolvePlayerDamage(player, enemyDamage);
+	}
+}
+
+void PhysicsSystem::playerHitByEnemyProjectile(Entity player, Entity enemyProjectile) {
+	if (registry.players.get(player).isDead) {
+		return;
+	}
+	Entity enemyEntity = registry.enemyProjectiles.get(enemyProjectile).belongToEnemy;
+	if (registry.enemies.has(enemyEntity)) {
+		int enemyDamage = registry.enemies.get(enemyEntity).damage;
+		resolvePlayerDamage(player, enemyDamage);
+		registry.remove_all_components_of(enemyProjectile);
+	}
 }
 
 void PhysicsSystem::handlePowerUpCollisions(Player& playerCom, PlayerStat& playerStatCom, Entity entity, bool isPlayerOne, bool isPlayerTwo, int powerUpCost) 
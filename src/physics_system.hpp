@@ -9,6 +9,7 @@
 // stlib
 #include <vector>
 #include <random>
+#include <array>
 
 // A simple physics system that moves rigid bodies and checks for collision
 class PhysicsSystem
@@ -16,14 +17,21 @@ class PhysicsSystem
 public:
 	PhysicsSystem::PhysicsSystem()
 	{
-		rng1 = std::default_random_engine(std::random_device()());
+		initializeCollisionHandlers();
 	};
 	void initializeSounds();
 	void step(float elapsed_ms, float window_width_px, float window_height_px);
 	void handle_collision();
 private:
-	std::default_random_engine rng1;
-	std::uniform_real_distribution<float> uniform_dist1;
+	// Collision response for a (entity, other) pair, looked up by the categories of both
+	typedef void (PhysicsSystem::*CollisionHandler)(Entity entity, Entity entity_other);
+	std::array<std::array<CollisionHandler, collider_category_count>, collider_category_count> collision_handlers;
+	void initializeCollisionHandlers();
+	void projectileHitsEnemy(Entity projectile, Entity enemy);
+	void swordHitsEnemy(Entity sword, Entity enemy);
+	void playerTouchesPowerup(Entity player, Entity powerup);
+	void playerTouchesEnemy(Entity player, Entity enemy);
+	void playerHitByEnemyProjectile(Entity player, Entity enemyProjectile);
 	vec2 get_bounding_box(const Motion& motion);
 	vec3 transformVertex(Motion& motion, ColoredVertex vertex);
 	bool doesRadiusCollide(const Motion& motion, const Motion& other_motion);
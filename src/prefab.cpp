@@ -0,0 +1,246 @@
+// internal
+#include "prefab.hpp"
+#include "ai_scheduler.hpp"
+#include "random.hpp"
+
+// stlib
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+
+EnemyPrefabLoader enemyPrefabLoader;
+
+static TEXTURE_ASSET_ID textureByName(const std::string& name) {
+	static const std::pair<const char*, TEXTURE_ASSET_ID> names[] = {
+		{ "ENEMY", TEXTURE_ASSET_ID::ENEMY },
+		{ "ENEMYRUN", TEXTURE_ASSET_ID::ENEMYRUN },
+		{ "ENEMYHUNTER", TEXTURE_ASSET_ID::ENEMYHUNTER },
+		{ "ENEMYBACTERIA", TEXTURE_ASSET_ID::ENEMYBACTERIA },
+		{ "ENEMYCHASE", TEXTURE_ASSET_ID::ENEMYCHASE },
+		{ "ENEMYSWARM", TEXTURE_ASSET_ID::ENEMYSWARM },
+		{ "GERM", TEXTURE_ASSET_ID::GERM },
+		{ "ENEMYASTAR", TEXTURE_ASSET_ID::ENEMYASTAR },
+		{ "HAND", TEXTURE_ASSET_ID::HAND },
+		{ "BOSS", TEXTURE_ASSET_ID::BOSS },
+		{ "ENEMYHEAD", TEXTURE_ASSET_ID::ENEMYHEAD },
+		{ "ENEMYTAIL", TEXTURE_ASSET_ID::ENEMYTAIL }
+	};
+	for (auto& entry : names) {
+		if (name == entry.first) return entry.second;
+	}
+	assert(false && "Unknown prefab texture");
+	return TEXTURE_ASSET_ID::TEXTURE_COUNT;
+}
+
+static EFFECT_ASSET_ID effectByName(const std::string& name) {
+	if (name == "BOSS") return EFFECT_ASSET_ID::BOSS;
+	assert(name == "ENEMY" && "Unknown prefab effect");
+	return EFFECT_ASSET_ID::ENEMY;
+}
+
+static GEOMETRY_BUFFER_ID hitboxByName(const std::string& name) {
+	static const std::pair<const char*, GEOMETRY_BUFFER_ID> names[] = {
+		{ "BLOBBER", GEOMETRY_BUFFER_ID::BLOBBER },
+		{ "RUNNER", GEOMETRY_BUFFER_ID::RUNNER },
+		{ "HUNTER", GEOMETRY_BUFFER_ID::HUNTER },
+		{ "BACTERIA", GEOMETRY_BUFFER_ID::BACTERIA },
+		{ "GERM", GEOMETRY_BUFFER_ID::GERM }
+	};
+	for (auto& entry : names) {
+		if (name == entry.first) return entry.second;
+	}
+	assert(false && "Unknown prefab hitbox");
+	return GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
+}
+
+void EnemyPrefabLoader::readFile() {
+	Json::Value root;
+	Json::CharReaderBuilder builder;
+	std::ifstream file(data_path() + "/prefabs/enemy_prefabs.json", std::ifstream::binary);
+	std::string errs;
+	bool parsedSuccessfully = Json::parseFromStream(builder, file, &root, &errs);
+	if (!parsedSuccessfully)
+	{   // Print error
+		std::cout << errs << "\n";
+	}
+	float scaling = defaultResolution.scaling;
+	auto jsonPrefabs = root["prefabs"];
+	for (Json::Value::ArrayIndex i = 0; i != jsonPrefabs.size(); i++) {
+		auto current = jsonPrefabs[i];
+		int type = current["type"].asInt();
+		assert(type >= 0 && type < enemy_prefab_count);
+		EnemyPrefab prefab;
+		prefab.loaded = true;
+
+		// enemy attributes
+		prefab.enemy.hp = current["hp"].asFloat();
+		prefab.enemy.max_hp = current.get("max_hp", prefab.enemy.hp).asFloat();
+		prefab.enemy.damage = current["damage"].asInt();
+		prefab.enemy.loot = current["loot"].asInt();
+		prefab.enemy.speed = current["speed"].asFloat() * scaling;
+		if (current.isMember("invincible_ms")) {
+			prefab.enemy.invinFrame = current["invincible_ms"].asFloat();
+			prefab.enemy.isInvin = true;
+		}
+
+		// motion and velocity
+		auto bb = current["bb"];
+		float bbScale = bb.get("scale", 1.f).asFloat();
+		prefab.motion.scale = vec2(bb["width"].asFloat() * bbScale, bb["height"].asFloat() * bbScale) * scaling;
+		prefab.velocityDirection = vec2(current["velocity"].get("x", 0.f).asFloat(), current["velocity"].get("y", 0.f).asFloat());
+		prefab.randomVelocity = current.get("random_velocity", false).asBool();
+		auto formation = current["formation"];
+		if (formation.size() > 0) {
+			prefab.formation.clear();
+			for (Json::Value::ArrayIndex j = 0; j != formation.size(); j++) {
+				prefab.formation.push_back(vec2(formation[j]["x"].asFloat(), formation[j]["y"].asFloat()) * scaling);
+			}
+		}
+
+		// rendering and collision
+		prefab.hasMesh = current.get("mesh", true).asBool();
+		if (current.isMember("hitbox")) {
+			prefab.hasHitbox = true;
+			prefab.hitbox = hitboxByName(current["hitbox"].asString());
+		}
+		if (current.isMember("texture")) {
+			prefab.hasRenderRequest = true;
+			prefab.renderRequest = { textureByName(current["texture"].asString()),
+				effectByName(current.get("effect", "ENEMY").asString()),
+				GEOMETRY_BUFFER_ID::SPRITE };
+		}
+
+		prefabs[type] = prefab;
+	}
+}
+
+const EnemyPrefab& EnemyPrefabLoader::get(int enemyType) {
+	assert(enemyType >= 0 && enemyType < enemy_prefab_count);
+	assert(prefabs[enemyType].loaded && "Enemy prefab missing from enemy_prefabs.json");
+	return prefabs[enemyType];
+}
+
+// Type specific components, each one is still a single batched insert
+static void attachArchetype(ENEMY_PREFAB_ID type, const std::vector<Entity>& batch) {
+	float scaling = defaultResolution.scaling;
+	switch (type) {
+		case ENEMY_PREFAB_ID::BLOB:
+			registry.enemyBlobs.insertBatch(batch, EnemyBlob());
+			break;
+		case ENEMY_PREFAB_ID::RUN:
+			registry.enemiesrun.insertBatch(batch, EnemyRun());
+			break;
+		case ENEMY_PREFAB_ID::HUNTER: {
+			EnemyHunter hunter;
+			hunter.currentState = hunter.searchingMode;
+			hunter.huntingRange *= scaling;
+			registry.enemyHunters.insertBatch(batch, hunter);
+			scheduleAIThinks(batch, hunter.aiUpdateTime, 0.f);
+			break;
+		}
+		case ENEMY_PREFAB_ID::BACTERIA:
+			registry.enemyBacterias.insertBatch(batch, EnemyBacteria());
+			break;
+		case ENEMY_PREFAB_ID::CHASE: {
+			EnemyChase chase;
+			registry.enemyChase.insertBatch(batch, chase);
+			scheduleAIThinks(batch, chase.aiUpdateTime, 0.f);
+			break;
+		}
+		case ENEMY_PREFAB_ID::SWARM:
+		case ENEMY_PREFAB_ID::MINION: {
+			EnemySwarm swarm;
+			swarm.projectileSpeed *= scaling;
+			registry.enemySwarms.insertBatch(batch, swarm);
+			scheduleAIThinks(batch, swarm.aiUpdateTime, swarm.firstAiUpdateDelay);
+			break;
+		}
+		case ENEMY_PREFAB_ID::GERM: {
+			uint first = registry.enemyGerms.insertBatch(batch, EnemyGerm());
+			registry.btBlackboards.insertBatch(batch, BTBlackboard());
+			for (uint i = 0; i < batch.size(); i++) {
+				Entity entity = batch[i];
+				registry.enemyGerms.components[first + i].mode = gameRandomInt(entity, RANDOM_PURPOSE::GERM_MODE, 1, 10);
+			}
+			break;
+		}
+		case ENEMY_PREFAB_ID::TUTORIAL:
+			registry.enemiesTutorial.insertBatch(batch, EnemyTutorial());
+			break;
+		case ENEMY_PREFAB_ID::ASTAR:
+			registry.enemyAStars.insertBatch(batch, EnemyAStar());
+			break;
+		case ENEMY_PREFAB_ID::BOSS_HAND: {
+			EnemySwarm hand;
+			hand.projectileSpeed = 300.f * scaling;
+			registry.enemySwarms.insertBatch(batch, hand);
+			registry.enemyBossHand.insertBatch(batch, EnemyBossHand());
+			scheduleAIThinks(batch, hand.aiUpdateTime, hand.firstAiUpdateDelay);
+			break;
+		}
+		case ENEMY_PREFAB_ID::BOSS: {
+			EnemyBoss boss;
+			registry.enemyBoss.insertBatch(batch, boss);
+			scheduleAIThinks(batch, boss.aiUpdateInterval, 0.f);
+			break;
+		}
+		case ENEMY_PREFAB_ID::COORD_HEAD: {
+			EnemyCoordHead head;
+			head.minDistFromTail *= scaling;
+			registry.enemyCoordHeads.insertBatch(batch, head);
+			scheduleAIThinks(batch, head.aiUpdateTime, 0.f);
+			break;
+		}
+		case ENEMY_PREFAB_ID::COORD_TAIL: {
+			EnemyCoordTail tail;
+			tail.minDistFromHead *= scaling;
+			uint first = registry.enemyCoordTails.insertBatch(batch, tail);
+			// tails are paired with heads by spawn order
+			for (uint i = 0; i < batch.size(); i++) {
+				Entity headEntity = registry.enemyCoordHeads.entities[first + i];
+				registry.enemyCoordHeads.get(headEntity).belongToTail = batch[i];
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+std::vector<Entity> spawnEnemies(RenderSystem* renderer, int enemyType, const std::vector<vec2>& positions) {
+	const EnemyPrefab& prefab = enemyPrefabLoader.get(enemyType);
+	size_t count = positions.size() * prefab.formation.size();
+	// reserve the entities
+	std::vector<Entity> batch(count);
+
+	if (prefab.hasMesh) {
+		registry.meshPtrs.insertBatch(batch, &renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE));
+	}
+	if (prefab.hasHitbox) {
+		registry.hitboxes.insertBatch(batch, &renderer->getMesh(prefab.hitbox));
+	}
+
+	uint firstMotion = registry.motions.insertBatch(batch, prefab.motion);
+	registry.enemies.insertBatch(batch, prefab.enemy);
+	registry.colliders.insertBatch(batch, { COLLIDER_CATEGORY::ENEMY });
+	registry.renderLayers.insertBatch(batch, { RENDER_LAYER::ENEMY });
+	const Enemy& enemyCom = prefab.enemy;
+	for (uint i = 0; i < count; i++) {
+		Motion& motion = registry.motions.components[firstMotion + i];
+		motion.position = positions[i / prefab.formation.size()] + prefab.formation[i % prefab.formation.size()];
+		if (prefab.randomVelocity) {
+			motion.velocity = vec2(gameRandom(batch[i], RANDOM_PURPOSE::SPAWN_VELOCITY, 0) * enemyCom.speed, gameRandom(batch[i], RANDOM_PURPOSE::SPAWN_VELOCITY, 1) * enemyCom.speed);
+		}
+		else {
+			motion.velocity = prefab.velocityDirection * enemyCom.speed;
+		}
+	}
+
+	attachArchetype((ENEMY_PREFAB_ID)enemyType, batch);
+
+	if (prefab.hasRenderRequest) {
+		registry.renderRequests.insertBatch(batch, prefab.renderRequest);
+	}
+	return batch;
+}
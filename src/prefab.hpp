@@ -0,0 +1,62 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+#include "render_system.hpp"
+
+// stlib
+#include <vector>
+
+// Enemy types, same ids as enemy_types in level_design.json
+enum class ENEMY_PREFAB_ID {
+	BLOB = 0,
+	RUN = BLOB + 1,
+	HUNTER = RUN + 1,
+	BACTERIA = HUNTER + 1,
+	CHASE = BACTERIA + 1,
+	SWARM = CHASE + 1,
+	GERM = SWARM + 1,
+	TUTORIAL = GERM + 1,
+	ASTAR = TUTORIAL + 1,
+	MINION = ASTAR + 1,
+	BOSS_HAND = MINION + 1,
+	BOSS = BOSS_HAND + 1,
+	COORD_HEAD = BOSS + 1,
+	COORD_TAIL = COORD_HEAD + 1,
+	PREFAB_COUNT = COORD_TAIL + 1
+};
+const int enemy_prefab_count = (int)ENEMY_PREFAB_ID::PREFAB_COUNT;
+
+// Component template block of one enemy type, compiled from data/prefabs/enemy_prefabs.json
+// with the resolution scaling already applied
+struct EnemyPrefab {
+	bool loaded = false;
+	bool hasMesh = true;
+	bool hasHitbox = false;
+	GEOMETRY_BUFFER_ID hitbox = GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
+	bool hasRenderRequest = false;
+	RenderRequest renderRequest;
+	Motion motion;
+	Enemy enemy;
+	// spawn velocity is velocityDirection * speed, or a random [0, speed) per axis
+	vec2 velocityDirection = { 0.f, 0.f };
+	bool randomVelocity = false;
+	// one instance is spawned at every offset around each spawn position
+	std::vector<vec2> formation = { { 0.f, 0.f } };
+};
+
+class EnemyPrefabLoader {
+private:
+	EnemyPrefab prefabs[enemy_prefab_count];
+public:
+	// Needs defaultResolution to be set
+	void readFile();
+	const EnemyPrefab& get(int enemyType);
+};
+
+extern EnemyPrefabLoader enemyPrefabLoader;
+
+// Spawns one formation of enemyType at every position. Every container gets a single batched
+// insert for the whole wave. Returns the new entities in spawn order
+std::vector<Entity> spawnEnemies(RenderSystem* renderer, int enemyType, const std::vector<vec2>& positions);
@@ -0,0 +1,55 @@
+// internal
+#include "random.hpp"
+
+// stlib
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+RandomClock randomClock;
+
+static uint64_t splitMix(uint64_t z) {
+	z += 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+uint64_t randomBits(uint64_t seed, unsigned int entity, unsigned int tick, RANDOM_PURPOSE purpose, unsigned int index) {
+	uint64_t hash = splitMix(seed ^ entity);
+	hash = splitMix(hash ^ tick);
+	return splitMix(hash ^ ((uint64_t)purpose << 32 | index));
+}
+
+uint64_t pickGameRandomSeed() {
+	const char* value = std::getenv(GAME_RANDOM_SEED_VARIABLE);
+	if (value != nullptr && *value != '\0') {
+		char* end = nullptr;
+		unsigned long long seed = std::strtoull(value, &end, 10);
+		if (*end == '\0') {
+			return seed;
+		}
+		fprintf(stderr, "Ignoring %s=%s, the seed must be a decimal number\n", GAME_RANDOM_SEED_VARIABLE, value);
+	}
+	return std::random_device()();
+}
+
+void seedGameRandom(uint64_t seed) {
+	randomClock.seed = seed;
+	randomClock.tick = 0;
+}
+
+void advanceGameRandom() {
+	randomClock.tick++;
+}
+
+float gameRandom(unsigned int entity, RANDOM_PURPOSE purpose, unsigned int index) {
+	// the top 24 bits fill a float mantissa exactly
+	uint64_t bits = randomBits(randomClock.seed, entity, randomClock.tick, purpose, index);
+	return (float)(bits >> 40) * (1.f / 16777216.f);
+}
+
+int gameRandomInt(unsigned int entity, RANDOM_PURPOSE purpose, int low, int high, unsigned int index) {
+	uint64_t bits = randomBits(randomClock.seed, entity, randomClock.tick, purpose, index);
+	return low + (int)(bits % (uint64_t)(high - low + 1));
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// stlib
+#include <cstdint>
+
+// What a random draw is for, so unrelated draws for the same entity on the same tick never share a number
+enum class RANDOM_PURPOSE {
+	WANDER = 0,
+	PICK_PLAYER = WANDER + 1,
+	TARGET_PLAYER = PICK_PLAYER + 1,
+	GERM_EXPLOSION = TARGET_PLAYER + 1,
+	GERM_MODE = GERM_EXPLOSION + 1,
+	SPAWN_VELOCITY = GERM_MODE + 1,
+	POWERUP = SPAWN_VELOCITY + 1,
+	BLOCK_COLOUR = POWERUP + 1,
+	PURPOSE_COUNT = BLOCK_COLOUR + 1
+};
+
+// Counter based random numbers. A draw is a SplitMix64 style hash of (seed, entity, tick, purpose, index)
+// rather than the next value of a shared generator, so it does not depend on the order systems or
+// AI workers ask for numbers, and a run replays exactly from its seed and inputs.
+// Draws not tied to an entity pass 0 and tell their draws apart with index
+uint64_t randomBits(uint64_t seed, unsigned int entity, unsigned int tick, RANDOM_PURPOSE purpose, unsigned int index);
+
+// Seed and tick of the current run
+struct RandomClock
+{
+	uint64_t seed = 0;
+	unsigned int tick = 0;
+};
+extern RandomClock randomClock;
+
+// Environment variable that fixes the seed of a run, e.g. KTV_RANDOM_SEED=1234 to replay a logged run
+const char* const GAME_RANDOM_SEED_VARIABLE = "KTV_RANDOM_SEED";
+// Seed for a new run, taken from GAME_RANDOM_SEED_VARIABLE when it is set, otherwise from std::random_device
+uint64_t pickGameRandomSeed();
+void seedGameRandom(uint64_t seed);
+// Called once per world step, draws on the same tick with the same key return the same number
+void advanceGameRandom();
+
+// Number in [0, 1) for the current tick
+float gameRandom(unsigned int entity, RANDOM_PURPOSE purpose, unsigned int index = 0);
+// Integer in [low, high] for the current tick
+int gameRandomInt(unsigned int entity, RANDOM_PURPOSE purpose, int low, int high, unsigned int index = 0);
@@ -0,0 +1,25 @@
+// internal
+#include "render_queue.hpp"
+
+void RenderQueue::sort()
+{
+	scratch.resize(packets.size());
+	for (int shift = 0; shift < 64; shift += 8) {
+		size_t counts[256] = { 0 };
+		for (const RenderPacket& packet : packets)
+			counts[(packet.key >> shift) & 0xff]++;
+		// every key has the same byte here, the pass would not move anything
+		if (counts[(packets.empty() ? 0 : packets[0].key >> shift) & 0xff] == packets.size())
+			continue;
+
+		size_t offset = 0;
+		for (size_t& count : counts) {
+			size_t bucket = count;
+			count = offset;
+			offset += bucket;
+		}
+		for (const RenderPacket& packet : packets)
+			scratch[counts[(packet.key >> shift) & 0xff]++] = packet;
+		packets.swap(scratch);
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// stlib
+#include <cstdint>
+#include <vector>
+
+#include "common.hpp"
+#include "components.hpp"
+
+// One draw the frame will issue, ordered by its key
+struct RenderPacket
+{
+	uint64_t key;
+	// index into registry.renderRequests
+	unsigned int request;
+};
+
+// Sort key, most significant field first: layer, effect, GL texture, then submission order.
+// Layers draw back to front. Inside a layer, sprites sharing a program and a texture become
+// neighbours so the sprite batch and the bind helpers see as few changes as possible. Which kind of
+// sprite covers which is decided by the layer bands, the effect only groups sprites inside one band
+inline uint64_t makeSortKey(RENDER_LAYER layer, EFFECT_ASSET_ID effect, GLuint texture, unsigned int sequence)
+{
+	return ((uint64_t)layer & 0xff) << 56
+		| ((uint64_t)effect & 0xff) << 48
+		| ((uint64_t)texture & 0xffff) << 32
+		| (uint64_t)sequence;
+}
+
+// Draw packets of one frame. Filled in any order, then radix sorted on the key
+class RenderQueue
+{
+public:
+	void clear() { packets.clear(); };
+	void push(uint64_t key, unsigned int request) { packets.push_back({ key, request }); };
+	// Stable LSD radix sort, one pass per key byte. Bytes every key shares are skipped,
+	// so a frame usually pays for the texture and sequence bytes only
+	void sort();
+
+	size_t size() const { return packets.size(); };
+	const RenderPacket& operator[](size_t i) const { return packets[i]; };
+
+private:
+	std::vector<RenderPacket> packets;
+	// ping-pong buffer of the sort, kept between frames
+	std::vector<RenderPacket> scratch;
+};
@@ -6,8 +6,12 @@
 #include "tiny_ecs_registry.hpp"
 #include "world_init.hpp"
 
-void RenderSystem::drawTexturedMesh(Entity entity,
-									const mat3 &projection)
+// stlib
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+void RenderSystem::drawTexturedMesh(Entity entity)
 {
 	Motion &motion = registry.motions.get(entity);
 
@@ -17,94 +21,68 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 	const GLuint used_effect_enum = (GLuint)render_request.used_effect;
 	assert(used_effect_enum != (GLuint)EFFECT_ASSET_ID::EFFECT_COUNT);
 	const GLuint program = (GLuint)effects[used_effect_enum];
-
-	// Setting shaders
-	glUseProgram(program);
-	gl_has_errors();
+	const EffectLocations& locations = effect_locations[used_effect_enum];
 
 	assert(render_request.used_geometry != GEOMETRY_BUFFER_ID::GEOMETRY_COUNT);
-	const GLuint vbo = vertex_buffers[(GLuint)render_request.used_geometry];
-	const GLuint ibo = index_buffers[(GLuint)render_request.used_geometry];
+	const GLuint vao = vertex_arrays[(GLuint)render_request.used_geometry][used_effect_enum];
+	assert(vao != 0 && "No vertex layout for this geometry and effect");
 
-	// Setting vertex and index buffers
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	// Setting shaders, the VAO holds the buffers and the attribute layout
+	useProgram(program);
+	bindVertexArray(vao);
 	gl_has_errors();
 
-	// Input data location as in the vertex buffer
+	// Effect specific inputs
 	if (render_request.used_effect == EFFECT_ASSET_ID::TEXTURED)
 	{
-		textureEffectSetup(program,entity);
+		textureEffectSetup(locations, entity);
 		gl_has_errors();
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::LINE)
 	{
-		GLint in_position_loc = glGetAttribLocation(program, "in_position");
-		GLint in_color_loc = glGetAttribLocation(program, "in_color");
-		gl_has_errors();
-
-		int size = 3;
-		glEnableVertexAttribArray(in_position_loc);
-		glVertexAttribPointer(in_position_loc, size, GL_FLOAT, GL_FALSE,
-							  sizeof(ColoredVertex), (void *)0);
-		gl_has_errors();
-
-		glEnableVertexAttribArray(in_color_loc);
-		glVertexAttribPointer(in_color_loc, size, GL_FLOAT, GL_FALSE,
-							  sizeof(ColoredVertex), (void *)sizeof(vec3));
-		gl_has_errors();
+		// vertex colours only
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::KNIGHT)
 	{
-		textureEffectSetup(program, entity);
+		textureEffectSetup(locations, entity);
 		KnightAnimation& knightAnimation = registry.knightAnimations.get(registry.players.entities.front());
-		GLint xFrame = glGetUniformLocation(program, "xFrame");
-		GLint yFrame = glGetUniformLocation(program, "yFrame");
-		glUniform1i(xFrame, knightAnimation.xFrame);
-		glUniform1i(yFrame, knightAnimation.yFrame);
-		playerEffects(program, entity);
+		glUniform1i(locations.xFrame, knightAnimation.xFrame);
+		glUniform1i(locations.yFrame, knightAnimation.yFrame);
+		playerEffects(locations, entity);
 		gl_has_errors();
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::WIZARD) {
-		textureEffectSetup(program, entity);
+		textureEffectSetup(locations, entity);
 		WizardAnimation& wizardAnimation = registry.wizardAnimations.get(registry.players.entities.back());
-		GLint frameWalk = glGetUniformLocation(program, "frameWalk");
-		GLint frameIdle = glGetUniformLocation(program, "frameIdle");
-		GLint frameAttack = glGetUniformLocation(program, "frameAttack");
-		GLint animationMode = glGetUniformLocation(program, "animationMode");
-		glUniform1i(frameWalk, wizardAnimation.frameWalk);
-		glUniform1i(frameIdle, wizardAnimation.frameIdle);
-		glUniform1i(frameAttack, wizardAnimation.frameAttack);
-		glUniform1i(animationMode, wizardAnimation.animationMode);
-		playerEffects(program, entity);
+		glUniform1i(locations.frameWalk, wizardAnimation.frameWalk);
+		glUniform1i(locations.frameIdle, wizardAnimation.frameIdle);
+		glUniform1i(locations.frameAttack, wizardAnimation.frameAttack);
+		glUniform1i(locations.animationMode, wizardAnimation.animationMode);
+		playerEffects(locations, entity);
 		gl_has_errors();
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::ENEMY || render_request.used_effect == EFFECT_ASSET_ID::BOSS)
 	{
-		textureEffectSetup(program, entity);
+		textureEffectSetup(locations, entity);
 		gl_has_errors();
-		enemyEffects(program, entity);
+		enemyEffects(locations, entity);
 		gl_has_errors();
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::NUMBER)
 	{
-		textureEffectSetup(program, entity);
-		GLint frame = glGetUniformLocation(program, "frame");
-		glUniform1i(frame, registry.numbers.get(entity).frame);
+		textureEffectSetup(locations, entity);
+		glUniform1i(locations.frame, registry.numbers.get(entity).frame);
 		gl_has_errors();
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::LETTER)
 	{
-		textureEffectSetup(program, entity);
-		GLint frame = glGetUniformLocation(program, "frame");
-		glUniform1i(frame, registry.letters.get(entity).frame);
+		textureEffectSetup(locations, entity);
+		glUniform1i(locations.frame, registry.letters.get(entity).frame);
 		gl_has_errors();
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::POWERUP)
 	{
-		textureEffectSetup(program, entity);
-		GLfloat time_loc = glGetUniformLocation(program, "time");
-		glUniform1f(time_loc, (float)(glfwGetTime() * 10.0f));
+		textureEffectSetup(locations, entity);
 		gl_has_errors();
 	}
 	else
@@ -112,66 +90,28 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 		assert(false && "Type of render request not supported");
 	}
 
-	// Getting lighting information and condition
-	GLint in_shop = glGetUniformLocation(program, "in_shop");
-	if (twoPlayer.inTwoPlayerMode) {
-		if (registry.inShops.has(registry.players.entities[0]) || registry.inShops.has(registry.players.entities[1])) {
-			glUniform1i(in_shop, 1);
-		}
-		else {
-			glUniform1i(in_shop, 0);
-		}
-	}
-	else {
-		if (registry.inShops.has(registry.players.entities[0])) {
-			glUniform1i(in_shop, 1);
-		}
-		else {
-			glUniform1i(in_shop, 0);
-		}
-	}
-	GLint ambient_light = glGetUniformLocation(program, "ambient_light");
-	GLint light_source_pos = glGetUniformLocation(program, "light_source_pos");
-	GLint light_col = glGetUniformLocation(program, "light_col");
-	GLint light_intensity = glGetUniformLocation(program, "light_intensity");
-	Lighting lighting = Lighting();
-	glUniform3fv(ambient_light, 1, (float*)& lighting.ambient_light);
-	glUniform2fv(light_source_pos, 1, (float*)& lighting.light_source_pos);
-	glUniform3fv(light_col, 1, (float*)& lighting.light_col);
-	glUniform1f(light_intensity, lighting.light_intensity);
-	gl_has_errors();
-
-	// Getting uniform locations for glUniform* calls
-	GLint color_uloc = glGetUniformLocation(program, "fcolor");
+	// Lighting, time and projection come from the frame constants block
 	const vec3 color = registry.colors.has(entity) ? registry.colors.get(entity) : vec3(1);
-	glUniform3fv(color_uloc, 1, (float *)&color);
+	glUniform3fv(locations.fcolor, 1, (float *)&color);
 	gl_has_errors();
 
-	// Get number of indices from index buffer, which has elements uint16_t
-	GLint size = 0;
-	glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
-	gl_has_errors();
-
-	GLsizei num_indices = size / sizeof(uint16_t);
-	// GLsizei num_triangles = num_indices / 3;
+	// Number of indices recorded when the geometry was uploaded
+	GLsizei num_indices = index_counts[(GLuint)render_request.used_geometry];
 
-	GLint currProgram;
-	glGetIntegerv(GL_CURRENT_PROGRAM, &currProgram);
+	// Only the animated effects rebuild the transform from its parts
+	if (locations.translate >= 0) {
+		Transform transformSeparate;
+		transformSeparate.translate(motion.position);
+		glUniformMatrix3fv(locations.translate, 1, GL_FALSE, (float *)&transformSeparate.mat);
+		transformSeparate.reset();
 
-	Transform transformSeparate;
-	transformSeparate.translate(motion.position);
-	GLuint translate_loc = glGetUniformLocation(currProgram, "translate");
-	glUniformMatrix3fv(translate_loc, 1, GL_FALSE, (float *)&transformSeparate.mat);
-	transformSeparate.reset();
+		transformSeparate.rotate(motion.angle);
+		glUniformMatrix3fv(locations.rotation, 1, GL_FALSE, (float *)&transformSeparate.mat);
+		transformSeparate.reset();
 
-	transformSeparate.rotate(motion.angle);
-	GLuint rotation_loc = glGetUniformLocation(currProgram, "rotation");
-	glUniformMatrix3fv(rotation_loc, 1, GL_FALSE, (float *)&transformSeparate.mat);
-	transformSeparate.reset();
-
-	transformSeparate.scale(motion.scale);
-	GLuint scale_loc = glGetUniformLocation(currProgram, "scale");
-	glUniformMatrix3fv(scale_loc, 1, GL_FALSE, (float *)&transformSeparate.mat);
+		transformSeparate.scale(motion.scale);
+		glUniformMatrix3fv(locations.scale, 1, GL_FALSE, (float *)&transformSeparate.mat);
+	}
 
 	Transform transform;
 	transform.translate(motion.position);
@@ -179,23 +119,327 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 	transform.scale(motion.scale);
 
 	// Setting uniform values to the currently bound program
-	GLuint transform_loc = glGetUniformLocation(currProgram, "transform");
-	glUniformMatrix3fv(transform_loc, 1, GL_FALSE, (float *)&transform.mat);
-	GLuint projection_loc = glGetUniformLocation(currProgram, "projection");
-	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
+	glUniformMatrix3fv(locations.transform, 1, GL_FALSE, (float *)&transform.mat);
 	gl_has_errors();
 	// Drawing of num_indices/3 triangles specified in the index buffer
 	glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, nullptr);
 	gl_has_errors();
+	frame_stats.drawCalls++;
+}
+
+bool RenderSystem::anyPlayerInShop() const
+{
+	if (registry.inShops.has(registry.players.entities[0]))
+		return true;
+	return twoPlayer.inTwoPlayerMode && registry.inShops.has(registry.players.entities[1]);
+}
+
+// Sprites whose per-entity state fits in a SpriteInstance
+bool RenderSystem::isBatchable(const RenderRequest& render_request) const
+{
+	if (render_request.used_geometry != GEOMETRY_BUFFER_ID::SPRITE)
+		return false;
+	return render_request.used_effect == EFFECT_ASSET_ID::TEXTURED
+		|| render_request.used_effect == EFFECT_ASSET_ID::NUMBER
+		|| render_request.used_effect == EFFECT_ASSET_ID::LETTER
+		|| render_request.used_effect == EFFECT_ASSET_ID::ENEMY;
+}
+
+void RenderSystem::batchSprite(Entity entity, const RenderRequest& render_request)
+{
+	const GLuint texture = texture_gl_handles[(GLuint)render_request.used_texture];
+	if (sprite_batch.full() || !sprite_batch.continuesRun(render_request.used_effect, texture)) {
+		if (!sprite_batch.empty())
+			flushSpriteBatch();
+		sprite_batch.begin(render_request.used_effect, texture);
+	}
+
+	Motion& motion = registry.motions.get(entity);
+	SpriteInstance instance;
+	instance.position = motion.position;
+	instance.scale = motion.scale;
+	instance.angle = motion.angle;
+	if (registry.colors.has(entity))
+		instance.tint = registry.colors.get(entity);
+
+	// The number and letter shaders pick their frame from a horizontal strip
+	// Digits and letters are never lit
+	if (render_request.used_effect == EFFECT_ASSET_ID::NUMBER) {
+		instance.frame = vec4(registry.numbers.get(entity).frame / 10.f, 0.f, 1.f / 10.f, 1.f);
+		instance.flags |= SPRITE_FLAG_UNLIT;
+	}
+	else if (render_request.used_effect == EFFECT_ASSET_ID::LETTER) {
+		instance.frame = vec4(registry.letters.get(entity).frame / 26.f, 0.f, 1.f / 26.f, 1.f);
+		instance.flags |= SPRITE_FLAG_UNLIT;
+	}
+	else if (render_request.used_effect == EFFECT_ASSET_ID::ENEMY) {
+		// Same inputs enemyEffects uploads as uniforms
+		Enemy& enemy = registry.enemies.get(entity);
+		instance.colorScale = enemy.max_hp - enemy.hp;
+		instance.hitVelocity = enemy.velocityOfPlayerHit;
+		instance.hitDamage = (float)enemy.damageOfPlayerHit;
+		if (enemy.isInvin)
+			instance.flags |= SPRITE_FLAG_INVINCIBLE;
+		if (enemy.isDead) {
+			DeadEnemy& deadEnemy = registry.deadEnemies.get(entity);
+			instance.flags |= SPRITE_FLAG_DEAD;
+			if (deadEnemy.gotCut)
+				instance.flags |= SPRITE_FLAG_CUT;
+			instance.animationTime = deadEnemy.deathTimer / deadEnemy.deathAnimationTime;
+		}
+	}
+	// Frames are relative to the texture, which may be a rectangle of an atlas page
+	const vec4& rect = texture_uv_rects[(GLuint)render_request.used_texture];
+	instance.frame = vec4(vec2(rect.x, rect.y) + vec2(instance.frame.x, instance.frame.y) * vec2(rect.z, rect.w),
+		vec2(instance.frame.z, instance.frame.w) * vec2(rect.z, rect.w));
+	sprite_batch.push(instance);
+}
+
+void RenderSystem::flushSpriteBatch()
+{
+	EFFECT_ASSET_ID batch_effect = sprite_batch.getEffect() == EFFECT_ASSET_ID::ENEMY ? EFFECT_ASSET_ID::ENEMY_BATCH : EFFECT_ASSET_ID::SPRITE_BATCH;
+	useProgram(effects[(GLuint)batch_effect]);
+	bindVertexArray(sprite_batch.getVertexArray());
+	bindTexture(sprite_batch.getTexture());
+	sprite_batch.upload();
+	frame_stats.stateChanges++;
+	gl_has_errors();
+
+	// The indices of the SPRITE quad, once per instance
+	glDrawElementsInstanced(GL_TRIANGLES, index_counts[(GLuint)GEOMETRY_BUFFER_ID::SPRITE], GL_UNSIGNED_SHORT, nullptr, sprite_batch.size());
+	gl_has_errors();
+	frame_stats.drawCalls++;
+	frame_stats.batchedSprites += sprite_batch.size();
+	sprite_batch.clear();
+}
+
+void RenderSystem::streamTextures()
+{
+	if (textures_streamed)
+		return;
+	int job;
+	DecodedImage image;
+	for (int i = 0; i < TEXTURE_UPLOADS_PER_FRAME && texture_decoder.poll(job, image); i++)
+		uploadTexture(job, image);
+	if (texture_decoder.remaining() > 0)
+		return;
+
+	textures_streamed = true;
+	printf("Texture startup, times from the start of initializeGlTextures:\n");
+	for (const TextureUpload& upload : texture_uploads) {
+		printf("  %-24s %s  decode %7.1f ms  upload %5.1f ms  ready at %7.1f ms\n", upload.name.c_str(),
+			upload.critical ? "critical" : "deferred", upload.decodeMs, upload.uploadMs, upload.readyMs);
+	}
+}
+
+void RenderSystem::requireTexture(TEXTURE_ASSET_ID id)
+{
+	const int job = texture_jobs[(GLuint)id];
+	if (!texture_uploads[job].resident)
+		uploadTexture(job, texture_decoder.wait(job));
+}
+
+// Consecutive plain sprites sharing an effect and a texture go out as one draw,
+// everything else keeps its own draw in between
+void RenderSystem::submitPackets(size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		const unsigned int request = render_queue[i].request;
+		Entity entity = registry.renderRequests.entities[request];
+		const RenderRequest& render_request = registry.renderRequests.components[request];
+		if (isBatchable(render_request)) {
+			batchSprite(entity, render_request);
+			continue;
+		}
+		if (!sprite_batch.empty())
+			flushSpriteBatch();
+		drawTexturedMesh(entity);
+	}
+	if (!sprite_batch.empty())
+		flushSpriteBatch();
+}
+
+// Copies the cached background and terrain of this view into the target framebuffer, drawing them
+// into a cache slot first when nothing matches. They sort first, so the copy leaves the target
+// exactly as drawing them would. Returns the first packet still to draw
+size_t RenderSystem::drawStaticLayer(const mat3& projection, int width, int height, GLuint target)
+{
+	size_t static_count = 0;
+	while (static_count < render_queue.size() && (render_queue[static_count].key >> 56) <= (uint64_t)RENDER_LAYER::TERRAIN)
+		static_count++;
+
+	const ivec2 size = { width, height };
+	const int in_shop = anyPlayerInShop() ? 1 : 0;
+	int slot = -1;
+	for (int i = 0; i < STATIC_LAYER_CACHE_SLOTS; i++) {
+		const StaticLayerCache& cache = static_layer_caches[i];
+		if (cache.valid && cache.size == size && cache.projection == projection && cache.in_shop == in_shop && cache.signature == static_signature)
+			slot = i;
+	}
+
+	if (slot < 0) {
+		slot = (last_static_layer + 1) % STATIC_LAYER_CACHE_SLOTS;
+		StaticLayerCache& cache = static_layer_caches[slot];
+		if (cache.frame_buffer == 0) {
+			glGenFramebuffers(1, &cache.frame_buffer);
+			glGenTextures(1, &cache.texture);
+		}
+		if (cache.size != size) {
+			glBindTexture(GL_TEXTURE_2D, cache.texture);
+			current_texture = cache.texture;
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glBindFramebuffer(GL_FRAMEBUFFER, cache.frame_buffer);
+			glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, cache.texture, 0);
+			assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+			cache.size = size;
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, cache.frame_buffer);
+		glClear(GL_COLOR_BUFFER_BIT);
+		submitPackets(0, static_count);
+		gl_has_errors();
+
+		cache.projection = projection;
+		cache.in_shop = in_shop;
+		cache.signature = static_signature;
+		cache.valid = true;
+		frame_stats.staticLayerRebuilds++;
+	}
+	else {
+		frame_stats.cachedStaticPackets = (int)static_count;
+	}
+	last_static_layer = slot;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, static_layer_caches[slot].frame_buffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, target);
+	gl_has_errors();
+	return static_count;
+}
+
+// Folds one value into a hash, splitmix64 finalizer
+static uint64_t mixHash(uint64_t hash, uint64_t value)
+{
+	uint64_t z = hash ^ (value + 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+static uint64_t floatBits(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+// Whether the bounds of a motion overlap the view of the projection. The projection only scales
+// and translates, so the test runs on the axis aligned box of the (possibly rotated) quad
+static bool inView(const mat3& projection, const Motion& motion)
+{
+	vec2 half_size = abs(motion.scale) / 2.f;
+	if (motion.angle != 0.f) {
+		float c = std::abs(cos(motion.angle));
+		float s = std::abs(sin(motion.angle));
+		half_size = vec2(c * half_size.x + s * half_size.y, s * half_size.x + c * half_size.y);
+	}
+	const vec3 center = projection * vec3(motion.position, 1.f);
+	const vec2 clip_half_size = vec2(std::abs(projection[0][0]) * half_size.x, std::abs(projection[1][1]) * half_size.y);
+	return std::abs(center.x) - clip_half_size.x <= 1.f + VIEW_CULL_MARGIN
+		&& std::abs(center.y) - clip_half_size.y <= 1.f + VIEW_CULL_MARGIN;
+}
+
+// One packet per visible entity, sorted so layers go back to front and state changes are grouped
+void RenderSystem::buildRenderQueue(const mat3& projection)
+{
+	render_queue.clear();
+	uint64_t signature = 0;
+	uint64_t static_count = 0;
+	for (uint i = 0; i < registry.renderRequests.size(); i++)
+	{
+		Entity entity = registry.renderRequests.entities[i];
+		if (!registry.motions.has(entity))
+			continue;
+		const RenderRequest& render_request = registry.renderRequests.components[i];
+		const RENDER_LAYER layer = registry.renderLayers.has(entity) ? registry.renderLayers.get(entity).layer : RENDER_LAYER::WORLD;
+		const Motion& motion = registry.motions.get(entity);
+		if (layer <= RENDER_LAYER::TERRAIN) {
+			// Summed so the container order, which removals reshuffle, does not matter
+			uint64_t hash = mixHash(entity, (uint64_t)render_request.used_texture << 16 | (uint64_t)render_request.used_effect << 8 | (uint64_t)render_request.used_geometry);
+			hash = mixHash(hash, floatBits(motion.position.x) << 32 | floatBits(motion.position.y));
+			hash = mixHash(hash, floatBits(motion.scale.x) << 32 | floatBits(motion.scale.y));
+			hash = mixHash(hash, floatBits(motion.angle));
+			if (registry.colors.has(entity)) {
+				const vec3& color = registry.colors.get(entity);
+				hash = mixHash(hash, floatBits(color.x) << 32 | floatBits(color.y));
+				hash = mixHash(hash, floatBits(color.z));
+			}
+			signature += hash;
+			static_count++;
+		}
+		// Knocked back enemies are moved by the vertex shader by up to their hit velocity,
+		// they are always drawn
+		const bool knocked_back = registry.enemies.has(entity) && registry.enemies.get(entity).isInvin;
+		if (!knocked_back && !inView(projection, motion)) {
+			frame_stats.culledPackets++;
+			continue;
+		}
+		if (render_request.used_texture != TEXTURE_ASSET_ID::TEXTURE_COUNT)
+			requireTexture(render_request.used_texture);
+		// keyed on the GL texture so sprites of one atlas page sort next to each other
+		const GLuint texture = render_request.used_texture == TEXTURE_ASSET_ID::TEXTURE_COUNT ? 0 : texture_gl_handles[(GLuint)render_request.used_texture];
+		render_queue.push(makeSortKey(layer, render_request.used_effect, texture, i), i);
+	}
+	render_queue.sort();
+	static_signature = mixHash(signature, static_count);
+	frame_stats.queuedPackets = (int)render_queue.size();
+}
+
+// Fills the frame constants block every program reads projection, time and lighting from
+void RenderSystem::updateFrameConstants(const mat3& projection)
+{
+	FrameConstants constants;
+	for (int i = 0; i < 3; i++) {
+		constants.projection[i] = vec4(projection[i], 0.f);
+	}
+	Lighting lighting = Lighting();
+	constants.ambient_light = lighting.ambient_light;
+	constants.time = (float)(glfwGetTime() * 10.0f);
+	constants.light_col = lighting.light_col;
+	constants.light_intensity = lighting.light_intensity;
+	constants.light_source_pos = lighting.light_source_pos;
+	constants.in_shop = anyPlayerInShop() ? 1 : 0;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, frame_constants_ubo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &constants);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_CONSTANTS_BINDING, frame_constants_ubo);
+	gl_has_errors();
+}
+
+bool RenderSystem::updatePostPasses()
+{
+	ScreenState& screen = registry.screenStates.get(screen_state_entity);
+	post_passes[(int)POST_PASS::BRIGHTEN] = screen.brighten_screen_factor > 0;
+
+	bool any = false;
+	for (bool enabled : post_passes) {
+		if (enabled)
+			frame_stats.postProcessPasses++;
+		any = any || enabled;
+	}
+	return any;
 }
 
 // draw the intermediate texture to the screen, with some distortion to simulate
-// water
+// water. Only runs when a post-process pass is enabled
 void RenderSystem::drawToScreen()
 {
 	// Setting shaders
 	// get the water texture, sprite mesh, and program
-	glUseProgram(effects[(GLuint)EFFECT_ASSET_ID::WATER]);
+	useProgram(effects[(GLuint)EFFECT_ASSET_ID::WATER]);
 	gl_has_errors();
 	// Clearing backbuffer
 	int w, h;
@@ -211,32 +455,18 @@ void RenderSystem::drawToScreen()
 	// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glDisable(GL_DEPTH_TEST);
 
-	// Draw the screen texture on the quad geometry
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE]);
-	glBindBuffer(
-		GL_ELEMENT_ARRAY_BUFFER,
-		index_buffers[(GLuint)GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE]); // Note, GL_ELEMENT_ARRAY_BUFFER associates
-																	 // indices to the bound GL_ARRAY_BUFFER
+	// Draw the screen texture on the quad geometry, the VAO holds its buffers and the
+	// position attribute
+	bindVertexArray(vertex_arrays[(GLuint)GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE][(GLuint)EFFECT_ASSET_ID::WATER]);
 	gl_has_errors();
-	const GLuint water_program = effects[(GLuint)EFFECT_ASSET_ID::WATER];
-	// Set clock
-	GLuint time_uloc = glGetUniformLocation(water_program, "time");
-	GLuint brighten_timer_uloc = glGetUniformLocation(water_program, "brighten_screen_factor");
-	glUniform1f(time_uloc, (float)(glfwGetTime() * 10.0f));
+	const EffectLocations& water_locations = effect_locations[(GLuint)EFFECT_ASSET_ID::WATER];
+	// The clock comes from the frame constants block
 	ScreenState& screen = registry.screenStates.get(screen_state_entity);
-	glUniform1f(brighten_timer_uloc, screen.brighten_screen_factor);
-	gl_has_errors();
-	// Set the vertex position and vertex texture coordinates (both stored in the
-	// same VBO)
-	GLint in_position_loc = glGetAttribLocation(water_program, "in_position");
-	glEnableVertexAttribArray(in_position_loc);
-	glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)0);
+	glUniform1f(water_locations.brighten_screen_factor, screen.brighten_screen_factor);
 	gl_has_errors();
 
 	// Bind our texture in Texture Unit 0
-	glActiveTexture(GL_TEXTURE0);
-
-	glBindTexture(GL_TEXTURE_2D, off_screen_render_buffer_color);
+	bindTexture(off_screen_render_buffer_color);
 	gl_has_errors();
 	// Draw
 	glDrawElements(
@@ -244,32 +474,80 @@ void RenderSystem::drawToScreen()
 		nullptr); // one triangle = 3 vertices; nullptr indicates that there is
 				  // no offset from the bound index buffer
 	gl_has_errors();
+	frame_stats.drawCalls++;
 
 	// get game over information
-	GLint game_over_uloc = glGetUniformLocation(water_program, "game_over_factor");
-
 	//if (screen.game_over_factor == 0 || screen.game_over_factor == 1) {
-	glUniform1i(game_over_uloc, screen.game_over_factor);
+	glUniform1i(water_locations.game_over_factor, screen.game_over_factor);
 	
 	gl_has_errors();
 }
 
+// Adds the frame to the running totals and prints them once a second, per frame except for the
+// rebuilds and uploads, which are counted over the whole second
+void RenderSystem::reportFrameStats()
+{
+	auto now = std::chrono::high_resolution_clock::now();
+	if (report_frames == 0)
+		report_start = now;
+	report_frames++;
+	report_totals.drawCalls += frame_stats.drawCalls;
+	report_totals.stateChanges += frame_stats.stateChanges;
+	report_totals.batchedSprites += frame_stats.batchedSprites;
+	report_totals.queuedPackets += frame_stats.queuedPackets;
+	report_totals.culledPackets += frame_stats.culledPackets;
+	report_totals.cachedStaticPackets += frame_stats.cachedStaticPackets;
+	report_totals.staticLayerRebuilds += frame_stats.staticLayerRebuilds;
+	report_totals.postProcessPasses += frame_stats.postProcessPasses;
+	report_totals.texturesUploaded += frame_stats.texturesUploaded;
+	report_totals.cpuMs += frame_stats.cpuMs;
+	if (std::chrono::duration_cast<std::chrono::milliseconds>(now - report_start).count() < 1000)
+		return;
+
+	const float frames = (float)report_frames;
+	fprintf(stderr, "Render stats over %d frames: %.1f draw calls, %.1f state changes, %.1f batched sprites, %.1f queued, %.1f culled, %.1f from the static cache, %.1f post passes, %.2f ms CPU per frame; %d static layer rebuilds, %d textures uploaded\n",
+		report_frames,
+		report_totals.drawCalls / frames,
+		report_totals.stateChanges / frames,
+		report_totals.batchedSprites / frames,
+		report_totals.queuedPackets / frames,
+		report_totals.culledPackets / frames,
+		report_totals.cachedStaticPackets / frames,
+		report_totals.postProcessPasses / frames,
+		report_totals.cpuMs / frames,
+		report_totals.staticLayerRebuilds,
+		report_totals.texturesUploaded);
+	report_totals = RenderStats();
+	report_frames = 0;
+}
+
 // Render our game world
 // http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-14-render-to-texture/
 void RenderSystem::draw()
 {
+	auto frame_start = std::chrono::high_resolution_clock::now();
+	frame_stats = RenderStats();
+	// Anything may have been bound since the last frame
+	current_program = 0;
+	current_vertex_array = 0;
+	current_texture = 0;
+
+	streamTextures();
+
 	// Getting size of window
 	int w, h;
 	glfwGetFramebufferSize(window, &w, &h);
 
-	// First render to the custom framebuffer
-	glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer);
+	// Render to the custom framebuffer when a post-process pass needs the scene as a texture,
+	// otherwise straight to the screen, skipping its colour and depth writes and the full-screen pass
+	const bool post_process = updatePostPasses();
+	const GLuint scene_target = post_process ? frame_buffer : 0;
+	glBindFramebuffer(GL_FRAMEBUFFER, scene_target);
 	gl_has_errors();
-	// Clearing backbuffer
 
 	glViewport(0, 0, w, h);
 
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	// The colour is overwritten by the static layer blit, and nothing tests depth
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glDisable(GL_DEPTH_TEST); // native OpenGL does not work with a depth buffer
@@ -278,19 +556,22 @@ void RenderSystem::draw()
 	gl_has_errors();
 
 	mat3 projection_2D = createProjectionMatrix(0.f, 0.f);
+	updateFrameConstants(projection_2D);
 
-	// Draw all textured meshes that have a position and size component
-	for (Entity entity : registry.renderRequests.entities)
-	{
-		if (!registry.motions.has(entity))
-			continue;
-		// Note, its not very efficient to access elements indirectly via the entity
-		// albeit iterating through all Sprites in sequence. A good point to optimize
-		drawTexturedMesh(entity, projection_2D);
-	}
+	// Draw all textured meshes that have a position and size component, in sort key order.
+	// The background and terrain come from the static layer cache, everything else is drawn on top
+	buildRenderQueue(projection_2D);
+	size_t first_dynamic = drawStaticLayer(projection_2D, w, h, scene_target);
+	submitPackets(first_dynamic, render_queue.size());
 
 	// Truely render to the screen
-	drawToScreen();
+	if (post_process)
+		drawToScreen();
+
+	// swap time is vsync waiting, not render work
+	frame_stats.cpuMs = (float)(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - frame_start)).count() / 1000;
+	if (report_stats)
+		reportFrameStats();
 
 	// flicker-free display with a double buffer
 	glfwSwapBuffers(window);
@@ -433,74 +714,65 @@ mat3 RenderSystem::createProjectionMatrix(float left, float top)
 	return projMat;
 }
 
-void RenderSystem::textureEffectSetup(const GLuint program, Entity entity) {
-	GLint in_position_loc = glGetAttribLocation(program, "in_position");
-	GLint in_texcoord_loc = glGetAttribLocation(program, "in_texcoord");
-	gl_has_errors();
-	assert(in_texcoord_loc >= 0);
-
-	int vertexSize = 3;
-	glEnableVertexAttribArray(in_position_loc);
-	glVertexAttribPointer(in_position_loc, vertexSize, GL_FLOAT, GL_FALSE,
-		sizeof(TexturedVertex), (void *)0);
+void RenderSystem::textureEffectSetup(const EffectLocations& locations, Entity entity) {
+	assert(locations.in_texcoord >= 0);
+	assert(registry.renderRequests.has(entity));
+	const GLuint used_texture = (GLuint)registry.renderRequests.get(entity).used_texture;
+	bindTexture(texture_gl_handles[used_texture]);
+	glUniform4fv(locations.uv_rect, 1, (float*)&texture_uv_rects[used_texture]);
 	gl_has_errors();
+}
 
-	int texCoordSize = 2;
-	glEnableVertexAttribArray(in_texcoord_loc);
-	glVertexAttribPointer(
-		in_texcoord_loc, texCoordSize, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex),
-		(void *)sizeof(
-			vec3)); // note the stride to skip the preceeding vertex position
-	// Enabling and binding texture to slot 0
-	glActiveTexture(GL_TEXTURE0);
-	gl_has_errors();
+// The bind helpers skip calls that would not change anything, and count the ones that do
+void RenderSystem::useProgram(GLuint program) {
+	if (program == current_program)
+		return;
+	glUseProgram(program);
+	current_program = program;
+	frame_stats.stateChanges++;
+}
 
-	assert(registry.renderRequests.has(entity));
-	GLuint texture_id =
-		texture_gl_handles[(GLuint)registry.renderRequests.get(entity).used_texture];
+void RenderSystem::bindVertexArray(GLuint vao) {
+	if (vao == current_vertex_array)
+		return;
+	glBindVertexArray(vao);
+	current_vertex_array = vao;
+	frame_stats.stateChanges++;
+}
 
-	glBindTexture(GL_TEXTURE_2D, texture_id);
-	gl_has_errors();
+// Everything samples from texture unit 0
+void RenderSystem::bindTexture(GLuint texture) {
+	if (texture == current_texture)
+		return;
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	current_texture = texture;
+	frame_stats.stateChanges++;
 }
 
-void RenderSystem::enemyEffects(const GLuint program, Entity entity) {
-	GLfloat colorScale = glGetUniformLocation(program, "color_scale");
+void RenderSystem::enemyEffects(const EffectLocations& locations, Entity entity) {
 	Enemy& enemy = registry.enemies.get(entity);
 	float color_scale_value = enemy.max_hp - enemy.hp;
-	glUniform1f(colorScale, color_scale_value);
-	GLint inInvin = glGetUniformLocation(program, "inInvin");
-	glUniform1i(inInvin, registry.enemies.get(entity).isInvin);
-	GLfloat time_loc = glGetUniformLocation(program, "time");
-	glUniform1f(time_loc, (float)(glfwGetTime() * 10.0f));
-	GLint hitVelocityLoc = glGetUniformLocation(program, "velocityOfPlayerHit");
-	glUniform2f(hitVelocityLoc, enemy.velocityOfPlayerHit.x, enemy.velocityOfPlayerHit.y);
-	GLint playerDamageLoc = glGetUniformLocation(program, "playerDamage");
-	glUniform1i(playerDamageLoc, enemy.damageOfPlayerHit);
-	GLint isDeadLoc = glGetUniformLocation(program, "isDead");
-	glUniform1i(isDeadLoc, enemy.isDead);
+	glUniform1f(locations.color_scale, color_scale_value);
+	glUniform1i(locations.inInvin, enemy.isInvin);
+	glUniform2f(locations.velocityOfPlayerHit, enemy.velocityOfPlayerHit.x, enemy.velocityOfPlayerHit.y);
+	glUniform1i(locations.playerDamage, enemy.damageOfPlayerHit);
+	glUniform1i(locations.isDead, enemy.isDead);
 	if (enemy.isDead) {
 		DeadEnemy& deadEnemy = registry.deadEnemies.get(entity);
-		GLint gotCutLoc = glGetUniformLocation(program, "gotCut");
-		glUniform1i(gotCutLoc, deadEnemy.gotCut);
-		GLfloat animationTimeLoc = glGetUniformLocation(program, "animationTime");
-		glUniform1f(animationTimeLoc, deadEnemy.deathTimer / deadEnemy.deathAnimationTime);
+		glUniform1i(locations.gotCut, deadEnemy.gotCut);
+		glUniform1f(locations.animationTime, deadEnemy.deathTimer / deadEnemy.deathAnimationTime);
 	}
 }
 
-void RenderSystem::playerEffects(const GLuint program, Entity entity) {
+void RenderSystem::playerEffects(const EffectLocations& locations, Entity entity) {
 	Player& player = registry.players.get(entity);
-	GLfloat colorScale = glGetUniformLocation(program, "color_scale");
 	float color_scale_value = registry.playerStats.get(player.playerStat).maxHp - player.hp;
-	glUniform1f(colorScale, color_scale_value);
-	GLint inInvin = glGetUniformLocation(program, "inInvin");
-	glUniform1i(inInvin, player.isInvin);
-	GLfloat time_loc = glGetUniformLocation(program, "time");
-	glUniform1f(time_loc, (float)(glfwGetTime() * 10.0f));
-	GLint isDeadLoc = glGetUniformLocation(program, "isDead");
-	glUniform1i(isDeadLoc, player.isDead);
+	glUniform1f(locations.color_scale, color_scale_value);
+	glUniform1i(locations.inInvin, player.isInvin);
+	glUniform1i(locations.isDead, player.isDead);
 	if (player.isDead) {
 		DeadPlayer& deadPlayer = registry.deadPlayers.get(entity);
-		GLfloat animationTimeLoc = glGetUniformLocation(program, "animationTime");
-		glUniform1f(animationTimeLoc, deadPlayer.deathTimer / deadPlayer.deathAnimationTime);
+		glUniform1f(locations.animationTime, deadPlayer.deathTimer / deadPlayer.deathAnimationTime);
 	}
 }
@@ -1,11 +1,149 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "common.hpp"
 #include "components.hpp"
+#include "image_decoder.hpp"
 #include "tiny_ecs.hpp"
+#include "render_queue.hpp"
+#include "sprite_batch.hpp"
+#include "texture_files.hpp"
+
+static_assert(sizeof(texture_files) / sizeof(texture_files[0]) == texture_count, "texture_files must list every TEXTURE_ASSET_ID");
+
+// Uniform block binding point of the FrameConstants block
+const GLuint FRAME_CONSTANTS_BINDING = 0;
+
+// std140 image of the FrameConstants block declared in the shaders
+struct FrameConstants {
+	// mat3 columns, each padded to a vec4
+	vec4 projection[3];
+	vec3 ambient_light;
+	float time;
+	vec3 light_col;
+	float light_intensity;
+	vec2 light_source_pos;
+	int in_shop;
+	float padding;
+};
+static_assert(offsetof(FrameConstants, ambient_light) == 48 && offsetof(FrameConstants, light_col) == 64
+	&& offsetof(FrameConstants, light_source_pos) == 80 && sizeof(FrameConstants) == 96, "FrameConstants must match std140");
+
+// Uniform and attribute locations of one effect, resolved once after linking.
+// -1 where the program does not use the name, glUniform* ignores those
+struct EffectLocations {
+	// attributes
+	GLint in_position = -1;
+	GLint in_texcoord = -1;
+	GLint in_color = -1;
+	// per-draw uniforms
+	GLint transform = -1;
+	GLint uv_rect = -1;
+	GLint translate = -1;
+	GLint rotation = -1;
+	GLint scale = -1;
+	GLint fcolor = -1;
+	GLint color_scale = -1;
+	GLint inInvin = -1;
+	GLint isDead = -1;
+	GLint gotCut = -1;
+	GLint animationTime = -1;
+	GLint velocityOfPlayerHit = -1;
+	GLint playerDamage = -1;
+	GLint frame = -1;
+	GLint xFrame = -1;
+	GLint yFrame = -1;
+	GLint frameWalk = -1;
+	GLint frameIdle = -1;
+	GLint frameAttack = -1;
+	GLint animationMode = -1;
+	GLint brighten_screen_factor = -1;
+	GLint game_over_factor = -1;
+
+	void resolve(GLuint program);
+};
+
+// Extra room around the view when culling, in clip space units. Covers the shake and cut
+// offsets the vertex shaders add to a sprite
+const float VIEW_CULL_MARGIN = 0.2f;
+
+// Screen effects of the post-process (water) program, enabled per frame from the ScreenState.
+// A frame with none enabled is drawn straight into the default framebuffer
+enum class POST_PASS {
+	// level start fade, brighten_screen_factor
+	BRIGHTEN = 0,
+	PASS_COUNT = BRIGHTEN + 1
+};
+const int post_pass_count = (int)POST_PASS::PASS_COUNT;
+
+// Vertex type a geometry buffer was uploaded with
+enum class VERTEX_FORMAT {
+	POSITION = 0,
+	TEXTURED = POSITION + 1,
+	COLORED = TEXTURED + 1
+};
+
+// Counters of the last frame, for profiling
+struct RenderStats {
+	int drawCalls = 0;
+	// program, buffer and texture binds
+	int stateChanges = 0;
+	int batchedSprites = 0;
+	// entities the render queue sorted
+	int queuedPackets = 0;
+	// entities left out because they are outside the view, e.g. the room the camera is not in
+	int culledPackets = 0;
+	// background and terrain draws replaced by the static layer blit
+	int cachedStaticPackets = 0;
+	int staticLayerRebuilds = 0;
+	// enabled post-process passes, 0 when the scene skipped the offscreen buffer
+	int postProcessPasses = 0;
+	// textures that finished streaming in
+	int texturesUploaded = 0;
+	float cpuMs = 0.f;
+};
+// Set to any value to print the frame statistics to stderr once a second
+const char* const RENDER_STATS_VARIABLE = "KTV_RENDER_STATS";
+
+// One image file the texture loader decodes and uploads: an atlas page or a single texture.
+// The GL texture name exists from the start, the pixels arrive once resident is set
+struct TextureUpload {
+	std::string path;
+	std::string name;
+	GLuint texture = 0;
+	// the texture it holds, -1 for an atlas page
+	int id = -1;
+	// needed by the menu or the first level, waited for during init
+	bool critical = false;
+	bool resident = false;
+	// startup report, readyMs is counted from the start of initializeGlTextures
+	float decodeMs = 0.f;
+	float uploadMs = 0.f;
+	float readyMs = 0.f;
+};
+// Streamed textures uploaded per frame, the copy into a pixel buffer is what the frame pays for
+const int TEXTURE_UPLOADS_PER_FRAME = 2;
+
+// One view of the background and terrain layers, drawn once into its own texture and copied
+// into the frame while nothing it was drawn from changes
+struct StaticLayerCache {
+	GLuint frame_buffer = 0;
+	GLuint texture = 0;
+	ivec2 size = { 0, 0 };
+	// what the snapshot was drawn with, any difference means drawing it again
+	mat3 projection = mat3(1.f);
+	int in_shop = 0;
+	uint64_t signature = 0;
+	bool valid = false;
+};
+// One per room the camera shows, the battle room and the shop below it
+const int STATIC_LAYER_CACHE_SLOTS = 2;
 
 // System responsible for setting up OpenGL and for rendering all the
 // visual entities in the game
@@ -18,7 +156,21 @@ class RenderSystem {
 	 * it is easier to debug and faster to execute for the computer.
 	 */
 	std::array<GLuint, texture_count> texture_gl_handles;
+	// Size of the source image, also for textures packed into the atlas
 	std::array<ivec2, texture_count> texture_dimensions;
+	// (u, v, width, height) of each texture inside the GL texture it is bound with,
+	// (0, 0, 1, 1) unless it lives on an atlas page
+	std::array<vec4, texture_count> texture_uv_rects;
+	// Startup streaming of the image files, see initializeGlTextures
+	ImageDecoder texture_decoder;
+	std::vector<TextureUpload> texture_uploads;
+	// upload each texture comes from, shared by every texture of an atlas page
+	std::array<int, texture_count> texture_jobs;
+	// used in turn, so one can still be read by the driver while the next is filled
+	std::array<GLuint, 2> upload_pbos;
+	size_t next_upload_pbo = 0;
+	std::chrono::high_resolution_clock::time_point texture_load_start;
+	bool textures_streamed = false;
 
 	// Make sure these paths remain in sync with the associated enumerators.
 	// Associated id with .obj path
@@ -38,73 +190,9 @@ class RenderSystem {
 		  // specify meshes of other assets here
 	};
 
-	// Make sure these paths remain in sync with the associated enumerators.
-	// SOURCE for enemyrun.png: https://store.line.me/stickershop/product/1014536/en
-	// SOURCE for enemy.png: https://www.klipartz.com/ru/search?q=%D0%B2%D0%B8%D1%80%D1%83%D1%81
-	// SOURCE for enemychase.png: https://commons.wikimedia.org/wiki/File:Average_prokaryote_cell-_unlabled.svg
-	// SOURCE for keys on help.png: https://support.apple.com/en-us/HT201236
-	// SOURCE for tail: https://roblox.fandom.com/wiki/Catalog:Earth_Dragon_Tail
-	const std::array<std::string, texture_count> texture_paths = {
-			textures_path("tree_red.png"),
-			textures_path("tree_orange.png"),
-			textures_path("tree_yellow.png"),
-			textures_path("waterball.png"),
-			textures_path("wizard.png"),
-			textures_path("wizard_disgust.png"),
-			textures_path("enemy.png"),
-			textures_path("enemyrun.png"),
-			textures_path("hunter1.png"),
-			textures_path("hunter2.png"),
-			textures_path("hunter3.png"),
-			textures_path("hunter4.png"),
-			textures_path("help.png"),
-			textures_path("yellow-bacteria.png"),
-			textures_path("enemychase.png"),
-			textures_path("knight.png"),
-			textures_path("Frame_1.png"),
-			textures_path("Frame_2.png"),
-			textures_path("Frame_3.png"),
-			textures_path("Frame_4.png"),
-			textures_path("Frame_5.png"),
-			textures_path("Frame_6.png"),
-			textures_path("swarm1.png"),
-			textures_path("swarm2.png"),
-			textures_path("fireball.png"),
-			textures_path("sword.png"),
-			textures_path("wizard_attack.png"),
-			textures_path("wizard_idle.png"),
-			textures_path("wizard_walk.png"),
-			textures_path("BTEnemy.png"),
-			textures_path("main_menu.png"),
-			textures_path("in_game_menu.png"),
-			textures_path("HpUp.png"), 
-			textures_path("attackSpeedUp.png"),
-			textures_path("movementUp.png"), 
-			textures_path("dmgUp.png"),
-			textures_path("background_new.png"),
-			textures_path("numbers.png"),
-			textures_path("coin.png"),
-			textures_path("hp.png"),
-			textures_path("knightIcon.png"),
-			textures_path("wizard_earring.png"), 
-			textures_path("caps_letters.png"), 
-			textures_path("small_letters.png"), 
-			textures_path("tutorial.png"), 
-			textures_path("shop-arrow.png"),
-			textures_path("AStarEnemy.png"),
-			textures_path("bg_final.png"),
-			textures_path("hand.png"),
-			textures_path("minion.png"),
-			textures_path("minioncrazy.png"),
-			textures_path("bossfireball.png"),
-			textures_path("boss.png"),
-			textures_path("enemyhead.png"),
-			textures_path("enemytail.png"),
-			textures_path("end_1.png"),
-			textures_path("end_2.png")
-	};
 
 	std::array<GLuint, effect_count> effects;
+	std::array<EffectLocations, effect_count> effect_locations;
 	// Make sure these paths remain in sync with the associated enumerators.
 	const std::array<std::string, effect_count> effect_paths = {
 		shader_path("coloured"),
@@ -117,12 +205,19 @@ class RenderSystem {
 		shader_path("number"),
 		shader_path("powerup"),
 		shader_path("letter"),
-		shader_path("boss")
+		shader_path("boss"),
+		shader_path("sprite_batch"),
+		shader_path("enemy_batch")
 	};
 
 	std::array<GLuint, geometry_count> vertex_buffers;
 	std::array<GLuint, geometry_count> index_buffers;
 	std::array<Mesh, geometry_count> meshes;
+	// Filled by bindVBOandIBO
+	std::array<GLsizei, geometry_count> index_counts;
+	std::array<VERTEX_FORMAT, geometry_count> geometry_formats;
+	// One VAO per geometry and effect whose attributes it can feed, 0 for the other pairs
+	std::array<std::array<GLuint, effect_count>, geometry_count> vertex_arrays;
 
 public:
 	// Initialize the window
@@ -132,6 +227,14 @@ public:
 	void bindVBOandIBO(GEOMETRY_BUFFER_ID gid, std::vector<T> vertices, std::vector<uint16_t> indices);
 
 	void initializeGlTextures();
+	// Points the textures packed by tools/atlas_packer at their page, false if there is no usable atlas
+	bool loadTextureAtlas();
+	int addTextureUpload(const std::string& path, const std::string& name, GLuint texture, int id, bool critical);
+	void uploadTexture(int job, const DecodedImage& image);
+	// Uploads what the decoder finished since the last frame and prints the startup report once all is in
+	void streamTextures();
+	// Blocks until the texture is resident, for a deferred texture drawn before it streamed in
+	void requireTexture(TEXTURE_ASSET_ID id);
 
 	void initializeGlEffects();
 
@@ -139,6 +242,8 @@ public:
 	Mesh& getMesh(GEOMETRY_BUFFER_ID id) { return meshes[(int)id]; };
 
 	void initializeGlGeometryBuffers();
+	// Needs the effects and the geometry buffers
+	void initializeGlVertexArrays();
 	// Initialize the screen texture used as intermediate render target
 	// The draw loop first renders to this texture, then it is used for the water
 	// shader
@@ -154,13 +259,26 @@ public:
 
 private:
 	// Internal drawing functions for each entity type
-	void drawTexturedMesh(Entity entity, const mat3& projection);
+	void drawTexturedMesh(Entity entity);
 	void drawToScreen();
 	void playerOneTransition(bool leaveShop);
 	void playerTwoTransition(bool leaveShop, vec2 player2Pos);
-	void textureEffectSetup(const GLuint program, Entity entity);
-	void enemyEffects(const GLuint program, Entity entity);
-	void playerEffects(const GLuint program, Entity entity);
+	void textureEffectSetup(const EffectLocations& locations, Entity entity);
+	void enemyEffects(const EffectLocations& locations, Entity entity);
+	void playerEffects(const EffectLocations& locations, Entity entity);
+	bool isBatchable(const RenderRequest& render_request) const;
+	void batchSprite(Entity entity, const RenderRequest& render_request);
+	void flushSpriteBatch();
+	void buildRenderQueue(const mat3& projection);
+	void submitPackets(size_t begin, size_t end);
+	size_t drawStaticLayer(const mat3& projection, int width, int height, GLuint target);
+	// Fills post_passes, true if any pass runs this frame
+	bool updatePostPasses();
+	void updateFrameConstants(const mat3& projection);
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vao);
+	void bindTexture(GLuint texture);
+	bool anyPlayerInShop() const;
 
 	// Window handle
 	GLFWwindow* window;
@@ -173,6 +291,29 @@ private:
 	GLuint off_screen_render_buffer_depth;
 
 	Entity screen_state_entity;
+
+	// VAO bound while nothing is drawn, e.g. during buffer uploads
+	GLuint default_vao;
+	std::array<bool, post_pass_count> post_passes;
+	RenderQueue render_queue;
+	std::array<StaticLayerCache, STATIC_LAYER_CACHE_SLOTS> static_layer_caches;
+	// slot drawn most recently, the other one is replaced first
+	int last_static_layer = 0;
+	// order independent hash of every background and terrain entity, see buildRenderQueue
+	uint64_t static_signature = 0;
+	SpriteBatch sprite_batch;
+	RenderStats frame_stats;
+	// frame_stats summed since the last report, kept when RENDER_STATS_VARIABLE is set
+	bool report_stats = false;
+	RenderStats report_totals;
+	int report_frames = 0;
+	std::chrono::high_resolution_clock::time_point report_start;
+	void reportFrameStats();
+	// GL state bound by the frame being drawn
+	GLuint current_program = 0;
+	GLuint current_vertex_array = 0;
+	GLuint current_texture = 0;
+	GLuint frame_constants_ubo;
 };
 
 bool loadEffectFromFile(
@@ -2,6 +2,8 @@
 #include "render_system.hpp"
 
 #include <array>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 
 #include "../ext/stb_image/stb_image.h"
@@ -20,6 +22,7 @@ bool RenderSystem::init(int width, int height, GLFWwindow* window_arg)
 
 	glfwMakeContextCurrent(window);
 	glfwSwapInterval(1); // vsync
+	report_stats = std::getenv(RENDER_STATS_VARIABLE) != nullptr;
 
 	// Load OpenGL function pointers
 	const int is_fine = gl3w_init();
@@ -43,11 +46,10 @@ bool RenderSystem::init(int width, int height, GLFWwindow* window_arg)
 	// code to use OpenGL 4.3 (not suported on mac) and add additional .h and .cpp
 	// glDebugMessageCallback((GLDEBUGPROC)errorCallback, nullptr);
 
-	// We are not really using VAO's but without at least one bound we will crash in
-	// some systems.
-	GLuint vao;
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
+	// Draws bind the VAO of their geometry and effect, this one is only bound while the
+	// buffers are uploaded. Without at least one bound we will crash in some systems.
+	glGenVertexArrays(1, &default_vao);
+	glBindVertexArray(default_vao);
 	gl_has_errors();
 
 	initScreenTexture();
@@ -55,35 +57,198 @@ bool RenderSystem::init(int width, int height, GLFWwindow* window_arg)
 	initializeGlEffects();
 	initializeGlGeometryBuffers();
 
+	initializeGlVertexArrays();
+
+	sprite_batch.init(vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::SPRITE], index_buffers[(GLuint)GEOMETRY_BUFFER_ID::SPRITE]);
+	glBindVertexArray(default_vao);
+	gl_has_errors();
+
 	return true;
 }
 
+// Only needed after the menu and the first level, these stream in while the game already runs
+static const TEXTURE_ASSET_ID deferred_textures[] = {
+	TEXTURE_ASSET_ID::FRAME1,
+	TEXTURE_ASSET_ID::FRAME2,
+	TEXTURE_ASSET_ID::FRAME3,
+	TEXTURE_ASSET_ID::FRAME4,
+	TEXTURE_ASSET_ID::FRAME5,
+	TEXTURE_ASSET_ID::FRAME6,
+	TEXTURE_ASSET_ID::END1,
+	TEXTURE_ASSET_ID::END2,
+	TEXTURE_ASSET_ID::FINALBACKGROUND,
+	TEXTURE_ASSET_ID::HAND,
+	TEXTURE_ASSET_ID::MINION,
+	TEXTURE_ASSET_ID::MINIONCRAZY,
+	TEXTURE_ASSET_ID::BOSSFIREBALL,
+	TEXTURE_ASSET_ID::BOSS,
+	TEXTURE_ASSET_ID::ENEMYHEAD,
+	TEXTURE_ASSET_ID::ENEMYTAIL
+};
+
+static bool isDeferred(int id)
+{
+	for (TEXTURE_ASSET_ID deferred : deferred_textures) {
+		if ((int)deferred == id)
+			return true;
+	}
+	return false;
+}
+
+// Queues every image file on the decoder, atlas pages first, then what the menu and the first
+// level show, then the deferred art. Only the critical part is waited for here, draw() uploads
+// the rest as it finishes
 void RenderSystem::initializeGlTextures()
 {
-    glGenTextures((GLsizei)texture_gl_handles.size(), texture_gl_handles.data());
-
-    for(uint i = 0; i < texture_paths.size(); i++)
-    {
-        const std::string& path = texture_paths[i];
-        ivec2& dimensions = texture_dimensions[i];
-
-        stbi_uc* data;
-        data  = stbi_load(path.c_str(), &dimensions.x, &dimensions.y, NULL, 4);
-
-        if (data == NULL)
-        {
-			const std::string message = "Could not load the file " + path + ".";
-            fprintf(stderr, "%s", message.c_str());
-            assert(false);
-        }
-        glBindTexture(GL_TEXTURE_2D, texture_gl_handles[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, dimensions.x, dimensions.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		gl_has_errors();
-        stbi_image_free(data);
-    }
+	texture_load_start = std::chrono::high_resolution_clock::now();
+	texture_gl_handles.fill(0);
+	texture_uv_rects.fill(vec4(0.f, 0.f, 1.f, 1.f));
+	texture_dimensions.fill(ivec2(0, 0));
+	texture_jobs.fill(-1);
+	if (!loadTextureAtlas())
+		fprintf(stderr, "No texture atlas in %s, loading every texture on its own.\n", atlas_path("").c_str());
+
+	// Full-screen art and anything the packer left out
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < texture_count; i++) {
+			if (texture_gl_handles[i] != 0 || isDeferred(i) != (pass == 1))
+				continue;
+			glGenTextures(1, &texture_gl_handles[i]);
+			addTextureUpload(textures_path(texture_files[i].name), texture_files[i].name, texture_gl_handles[i], i, pass == 0);
+		}
+	}
+	for (int i = 0; i < texture_count; i++) {
+		texture_uploads[texture_jobs[i]].critical |= !isDeferred(i);
+	}
+
+	std::vector<std::string> paths;
+	for (const TextureUpload& upload : texture_uploads)
+		paths.push_back(upload.path);
+	texture_decoder.start(paths);
+
+	glGenBuffers((GLsizei)upload_pbos.size(), upload_pbos.data());
+	for (size_t job = 0; job < texture_uploads.size(); job++) {
+		if (texture_uploads[job].critical)
+			uploadTexture((int)job, texture_decoder.wait((int)job));
+	}
+	float critical_ms = (float)(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - texture_load_start)).count() / 1000;
+	printf("Textures for the menu and the first level ready after %.1f ms, %d more streaming in\n", critical_ms, texture_decoder.remaining());
+	gl_has_errors();
+}
+
+int RenderSystem::addTextureUpload(const std::string& path, const std::string& name, GLuint texture, int id, bool critical)
+{
+	TextureUpload upload;
+	upload.path = path;
+	upload.name = name;
+	upload.texture = texture;
+	upload.id = id;
+	upload.critical = critical;
+	texture_uploads.push_back(upload);
+	int job = (int)texture_uploads.size() - 1;
+	if (id >= 0)
+		texture_jobs[id] = job;
+	return job;
+}
+
+// Hands a decoded image to GL through a pixel buffer object. The copy into the mapped buffer
+// returns at once and the driver moves the pixels to the texture on its own time
+void RenderSystem::uploadTexture(int job, const DecodedImage& image)
+{
+	auto upload_start = std::chrono::high_resolution_clock::now();
+	TextureUpload& upload = texture_uploads[job];
+	if (image.pixels == nullptr)
+	{
+		const std::string message = "Could not load the file " + upload.path + ".";
+		fprintf(stderr, "%s", message.c_str());
+		assert(false);
+		upload.resident = true;
+		return;
+	}
+
+	const GLsizeiptr bytes = (GLsizeiptr)image.size.x * image.size.y * 4;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbos[next_upload_pbo]);
+	next_upload_pbo = (next_upload_pbo + 1) % upload_pbos.size();
+	// orphaned, so an upload still reading the previous contents does not stall the copy
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	memcpy(mapped, image.pixels, (size_t)bytes);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	bindTexture(upload.texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.size.x, image.size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 	gl_has_errors();
+	stbi_image_free(image.pixels);
+
+	if (upload.id >= 0)
+		texture_dimensions[upload.id] = image.size;
+	auto now = std::chrono::high_resolution_clock::now();
+	upload.decodeMs = image.decodeMs;
+	upload.uploadMs = (float)(std::chrono::duration_cast<std::chrono::microseconds>(now - upload_start)).count() / 1000;
+	upload.readyMs = (float)(std::chrono::duration_cast<std::chrono::microseconds>(now - texture_load_start)).count() / 1000;
+	upload.resident = true;
+	frame_stats.texturesUploaded++;
+}
+
+bool RenderSystem::loadTextureAtlas()
+{
+	std::ifstream file(atlas_path("atlas.json"), std::ifstream::binary);
+	if (!file)
+		return false;
+	Json::Value root;
+	Json::CharReaderBuilder builder;
+	std::string errs;
+	if (!Json::parseFromStream(builder, file, &root, &errs))
+	{
+		std::cout << errs << "\n";
+		return false;
+	}
+
+	// A table from an older texture list would put sprites on the wrong ids, and a hand-edited or
+	// truncated one could point past the page list
+	const Json::Value& textures = root["textures"];
+	const Json::Value& pages = root["pages"];
+	for (Json::Value::ArrayIndex i = 0; i != textures.size(); i++) {
+		const Json::Value& entry = textures[i];
+		int id = entry["id"].isInt() ? entry["id"].asInt() : -1;
+		int page = entry["page"].isInt() ? entry["page"].asInt() : -1;
+		if (id < 0 || id >= texture_count || entry["file"].asString() != texture_files[id].name
+			|| page < 0 || page >= (int)pages.size()) {
+			fprintf(stderr, "%s is out of date, run the atlas target again.\n", atlas_path("atlas.json").c_str());
+			return false;
+		}
+	}
+	// Pages are decoded later, a missing one has to be caught while single textures can still stand in
+	for (Json::Value::ArrayIndex i = 0; i != pages.size(); i++) {
+		if (!std::ifstream(atlas_path(pages[i].asString()), std::ifstream::binary)) {
+			fprintf(stderr, "Could not open the file %s.\n", atlas_path(pages[i].asString()).c_str());
+			return false;
+		}
+	}
+
+	std::vector<int> page_jobs(pages.size());
+	for (Json::Value::ArrayIndex i = 0; i != pages.size(); i++) {
+		GLuint page;
+		glGenTextures(1, &page);
+		// which textures are on a page, and so whether it is critical, is known below
+		page_jobs[i] = addTextureUpload(atlas_path(pages[i].asString()), pages[i].asString(), page, -1, false);
+	}
+
+	const float page_size = root["page_size"].asFloat();
+	for (Json::Value::ArrayIndex i = 0; i != textures.size(); i++) {
+		const Json::Value& entry = textures[i];
+		int id = entry["id"].asInt();
+		int job = page_jobs[entry["page"].asInt()];
+		texture_jobs[id] = job;
+		texture_gl_handles[id] = texture_uploads[job].texture;
+		texture_uv_rects[id] = vec4(entry["x"].asFloat(), entry["y"].asFloat(), entry["width"].asFloat(), entry["height"].asFloat()) / page_size;
+		// Sprites keep their scale from the source image, not the downscaled copy
+		texture_dimensions[id] = ivec2(entry["source_width"].asInt(), entry["source_height"].asInt());
+	}
+	return true;
 }
 
 void RenderSystem::initializeGlEffects()
@@ -95,13 +260,66 @@ void RenderSystem::initializeGlEffects()
 
 		bool is_valid = loadEffectFromFile(vertex_shader_name, fragment_shader_name, effects[i]);
 		assert(is_valid && (GLuint)effects[i] != 0);
+
+		// The frame loop never looks a name up
+		effect_locations[i].resolve(effects[i]);
+		GLuint frame_block = glGetUniformBlockIndex(effects[i], "FrameConstants");
+		if (frame_block != GL_INVALID_INDEX)
+			glUniformBlockBinding(effects[i], frame_block, FRAME_CONSTANTS_BINDING);
+		gl_has_errors();
 	}
+
+	// Filled once per frame by updateFrameConstants
+	glGenBuffers(1, &frame_constants_ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, frame_constants_ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_CONSTANTS_BINDING, frame_constants_ubo);
+	gl_has_errors();
 }
 
+void EffectLocations::resolve(GLuint program)
+{
+	in_position = glGetAttribLocation(program, "in_position");
+	in_texcoord = glGetAttribLocation(program, "in_texcoord");
+	in_color = glGetAttribLocation(program, "in_color");
+
+	transform = glGetUniformLocation(program, "transform");
+	uv_rect = glGetUniformLocation(program, "uv_rect");
+	translate = glGetUniformLocation(program, "translate");
+	rotation = glGetUniformLocation(program, "rotation");
+	scale = glGetUniformLocation(program, "scale");
+	fcolor = glGetUniformLocation(program, "fcolor");
+	color_scale = glGetUniformLocation(program, "color_scale");
+	inInvin = glGetUniformLocation(program, "inInvin");
+	isDead = glGetUniformLocation(program, "isDead");
+	gotCut = glGetUniformLocation(program, "gotCut");
+	animationTime = glGetUniformLocation(program, "animationTime");
+	velocityOfPlayerHit = glGetUniformLocation(program, "velocityOfPlayerHit");
+	playerDamage = glGetUniformLocation(program, "playerDamage");
+	frame = glGetUniformLocation(program, "frame");
+	xFrame = glGetUniformLocation(program, "xFrame");
+	yFrame = glGetUniformLocation(program, "yFrame");
+	frameWalk = glGetUniformLocation(program, "frameWalk");
+	frameIdle = glGetUniformLocation(program, "frameIdle");
+	frameAttack = glGetUniformLocation(program, "frameAttack");
+	animationMode = glGetUniformLocation(program, "animationMode");
+	brighten_screen_factor = glGetUniformLocation(program, "brighten_screen_factor");
+	game_over_factor = glGetUniformLocation(program, "game_over_factor");
+	gl_has_errors();
+}
+
+static VERTEX_FORMAT vertexFormatOf(const vec3&) { return VERTEX_FORMAT::POSITION; }
+static VERTEX_FORMAT vertexFormatOf(const TexturedVertex&) { return VERTEX_FORMAT::TEXTURED; }
+static VERTEX_FORMAT vertexFormatOf(const ColoredVertex&) { return VERTEX_FORMAT::COLORED; }
+
 // One could merge the following two functions as a template function...
 template <class T>
 void RenderSystem::bindVBOandIBO(GEOMETRY_BUFFER_ID gid, std::vector<T> vertices, std::vector<uint16_t> indices)
 {
+	// Draws read these instead of querying the buffers
+	index_counts[(uint)gid] = (GLsizei)indices.size();
+	geometry_formats[(uint)gid] = vertexFormatOf(vertices[0]);
+
 	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffers[(uint)gid]);
 	glBufferData(GL_ARRAY_BUFFER,
 		sizeof(vertices[0]) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
@@ -247,15 +465,91 @@ void RenderSystem::initializeGlGeometryBuffers()
 	bindVBOandIBO(GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE, screen_vertices, screen_indices);
 }
 
+// Layout of the attributes an effect reads, in a buffer of the given vertex format
+static bool specifyAttributes(const EffectLocations& locations, VERTEX_FORMAT format)
+{
+	if (locations.in_position < 0)
+		return false;
+	if ((locations.in_texcoord >= 0) != (format == VERTEX_FORMAT::TEXTURED))
+		return false;
+	if ((locations.in_color >= 0) != (format == VERTEX_FORMAT::COLORED))
+		return false;
+
+	GLsizei stride = sizeof(vec3);
+	if (format == VERTEX_FORMAT::TEXTURED)
+		stride = sizeof(TexturedVertex);
+	else if (format == VERTEX_FORMAT::COLORED)
+		stride = sizeof(ColoredVertex);
+
+	glEnableVertexAttribArray(locations.in_position);
+	glVertexAttribPointer(locations.in_position, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+	// texcoord and colour both follow the position
+	if (locations.in_texcoord >= 0) {
+		glEnableVertexAttribArray(locations.in_texcoord);
+		glVertexAttribPointer(locations.in_texcoord, 2, GL_FLOAT, GL_FALSE, stride, (void*)sizeof(vec3));
+	}
+	if (locations.in_color >= 0) {
+		glEnableVertexAttribArray(locations.in_color);
+		glVertexAttribPointer(locations.in_color, 3, GL_FLOAT, GL_FALSE, stride, (void*)sizeof(vec3));
+	}
+	gl_has_errors();
+	return true;
+}
+
+void RenderSystem::initializeGlVertexArrays()
+{
+	for (uint g = 0; g < geometry_count; g++)
+	{
+		for (uint e = 0; e < effect_count; e++)
+		{
+			vertex_arrays[g][e] = 0;
+			// the batch effects draw from the sprite batch VAO
+			if (e == (uint)EFFECT_ASSET_ID::SPRITE_BATCH || e == (uint)EFFECT_ASSET_ID::ENEMY_BATCH)
+				continue;
+
+			GLuint vao;
+			glGenVertexArrays(1, &vao);
+			glBindVertexArray(vao);
+			glBindBuffer(GL_ARRAY_BUFFER, vertex_buffers[g]);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffers[g]);
+			if (specifyAttributes(effect_locations[e], geometry_formats[g])) {
+				vertex_arrays[g][e] = vao;
+			}
+			else {
+				glBindVertexArray(default_vao);
+				glDeleteVertexArrays(1, &vao);
+			}
+			gl_has_errors();
+		}
+	}
+	glBindVertexArray(default_vao);
+	gl_has_errors();
+}
+
 RenderSystem::~RenderSystem()
 {
 	// Don't need to free gl resources since they last for as long as the program,
 	// but it's polite to clean after yourself.
 	glDeleteBuffers((GLsizei)vertex_buffers.size(), vertex_buffers.data());
 	glDeleteBuffers((GLsizei)index_buffers.size(), index_buffers.data());
+	// Atlas pages are listed once per texture on them, names already deleted are skipped
 	glDeleteTextures((GLsizei)texture_gl_handles.size(), texture_gl_handles.data());
 	glDeleteTextures(1, &off_screen_render_buffer_color);
 	glDeleteRenderbuffers(1, &off_screen_render_buffer_depth);
+	glDeleteBuffers((GLsizei)upload_pbos.size(), upload_pbos.data());
+	for (StaticLayerCache& cache : static_layer_caches) {
+		glDeleteFramebuffers(1, &cache.frame_buffer);
+		glDeleteTextures(1, &cache.texture);
+	}
+	sprite_batch.destroy();
+	glDeleteBuffers(1, &frame_constants_ubo);
+	for (auto& geometry_arrays : vertex_arrays) {
+		for (GLuint vao : geometry_arrays) {
+			if (vao != 0)
+				glDeleteVertexArrays(1, &vao);
+		}
+	}
+	glDeleteVertexArrays(1, &default_vao);
 	gl_has_errors();
 
 	for(uint i = 0; i < effect_count; i++) {
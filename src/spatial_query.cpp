@@ -0,0 +1,191 @@
+// internal
+#include "spatial_query.hpp"
+
+// stlib
+#include <algorithm>
+#include <cmath>
+
+void SpatialQuery::build(float cellSize) {
+	// gather positions in registry order first, they are bucketed below
+	positions.clear();
+	unsorted.clear();
+	for (uint i = 0; i < registry.enemies.size(); i++) {
+		Entity entity = registry.enemies.entities[i];
+		if (registry.motions.has(entity)) {
+			unsorted.push_back(entity);
+			positions.push_back(registry.motions.get(entity).position);
+		}
+	}
+	// the second player only counts while they are in the game
+	for (uint i = 0; i < registry.players.size(); i++) {
+		if (i > 0 && !twoPlayer.inTwoPlayerMode) {
+			break;
+		}
+		Entity entity = registry.players.entities[i];
+		unsorted.push_back(entity);
+		positions.push_back(registry.motions.get(entity).position);
+	}
+
+	int count = (int)positions.size();
+	xs.resize(count);
+	ys.resize(count);
+	entities.clear();
+	if (count == 0) {
+		cols = rows = 0;
+		cellStart.assign(1, 0);
+		return;
+	}
+
+	vec2 minCorner = positions[0];
+	vec2 maxCorner = positions[0];
+	for (vec2 position : positions) {
+		minCorner = min(minCorner, position);
+		maxCorner = max(maxCorner, position);
+	}
+	vec2 extent = maxCorner - minCorner;
+	this->cellSize = cellSize;
+	while ((int(extent.x / this->cellSize) + 1) * (int(extent.y / this->cellSize) + 1) > SPATIAL_MAX_CELLS) {
+		this->cellSize *= 2.f;
+	}
+	origin = minCorner;
+	cols = int(extent.x / this->cellSize) + 1;
+	rows = int(extent.y / this->cellSize) + 1;
+
+	// counting sort by bucket
+	cellStart.assign(cols * rows + 1, 0);
+	entryCell.resize(count);
+	for (int i = 0; i < count; i++) {
+		ivec2 cell = cellOf(positions[i]);
+		entryCell[i] = cell.y * cols + cell.x;
+		cellStart[entryCell[i] + 1]++;
+	}
+	for (int c = 0; c < cols * rows; c++) {
+		cellStart[c + 1] += cellStart[c];
+	}
+	order.resize(count);
+	fill.assign(cellStart.begin(), cellStart.end() - 1);
+	for (int i = 0; i < count; i++) {
+		order[fill[entryCell[i]]++] = i;
+	}
+	for (int i = 0; i < count; i++) {
+		xs[i] = positions[order[i]].x;
+		ys[i] = positions[order[i]].y;
+		entities.push_back(unsorted[order[i]]);
+	}
+}
+
+ivec2 SpatialQuery::cellOf(vec2 position) const {
+	ivec2 cell = ivec2(floor((position - origin) / cellSize));
+	return clamp(cell, ivec2(0, 0), ivec2(cols - 1, rows - 1));
+}
+
+// Agents whose distances are computed per batch, small enough to live on the stack
+static const int SPATIAL_DISTANCE_CHUNK = 64;
+
+template <typename Visit>
+void SpatialQuery::forEachDistance(vec2 center, int begin, int end, Visit visit) const {
+	float distSq[SPATIAL_DISTANCE_CHUNK];
+	const float* x = xs.data();
+	const float* y = ys.data();
+	for (int chunk = begin; chunk < end; chunk += SPATIAL_DISTANCE_CHUNK) {
+		int count = std::min(SPATIAL_DISTANCE_CHUNK, end - chunk);
+		for (int i = 0; i < count; i++) {
+			float dx = x[chunk + i] - center.x;
+			float dy = y[chunk + i] - center.y;
+			distSq[i] = dx * dx + dy * dy;
+		}
+		for (int i = 0; i < count; i++) {
+			visit(chunk + i, distSq[i]);
+		}
+	}
+}
+
+template <typename Visit>
+void SpatialQuery::forEachInRadius(vec2 center, float radius, ContainerInterface* type, Visit visit) const {
+	if (cols == 0) {
+		return;
+	}
+	float radiusSq = radius * radius;
+	ivec2 low = cellOf(center - vec2(radius, radius));
+	ivec2 high = cellOf(center + vec2(radius, radius));
+	for (int row = low.y; row <= high.y; row++) {
+		// the buckets of a row are contiguous, so a row segment is a single span
+		int begin = cellStart[row * cols + low.x];
+		int end = cellStart[row * cols + high.x + 1];
+		forEachDistance(center, begin, end, [&](int i, float distSq) {
+			if (distSq <= radiusSq && (type == nullptr || type->has(entities[i]))) {
+				visit(i, distSq);
+			}
+		});
+	}
+}
+
+void SpatialQuery::queryRadius(vec2 center, float radius, ContainerInterface* type, std::vector<Entity>& out) const {
+	out.clear();
+	forEachInRadius(center, radius, type, [&](int i, float) {
+		out.push_back(entities[i]);
+	});
+}
+
+bool SpatialQuery::findNearest(vec2 center, float maxRadius, ContainerInterface* type, Entity self, Entity& out) const {
+	if (cols == 0) {
+		return false;
+	}
+	// grow the searched square ring by ring until nothing outside it can be closer
+	ivec2 centerCell = cellOf(center);
+	float maxRadiusSq = maxRadius * maxRadius;
+	float bestSq = maxRadiusSq;
+	int best = -1;
+	unsigned int selfId = self;
+	// stop at the last ring that still overlaps the grid, or that maxRadius can reach
+	int maxRing = std::max(std::max(centerCell.x, cols - 1 - centerCell.x), std::max(centerCell.y, rows - 1 - centerCell.y));
+	if (maxRadius / cellSize < (float)maxRing) {
+		maxRing = (int)(maxRadius / cellSize) + 1;
+	}
+	for (int ring = 0; ring <= maxRing; ring++) {
+		ivec2 low = max(centerCell - ivec2(ring, ring), ivec2(0, 0));
+		ivec2 high = min(centerCell + ivec2(ring, ring), ivec2(cols - 1, rows - 1));
+		for (int row = low.y; row <= high.y; row++) {
+			bool edgeRow = row == centerCell.y - ring || row == centerCell.y + ring;
+			// inner rows of the ring only add their leftmost and rightmost bucket
+			int step = edgeRow ? 1 : std::max(2 * ring, 1);
+			for (int col = centerCell.x - ring; col <= centerCell.x + ring; col += step) {
+				if (col < low.x || col > high.x) {
+					continue;
+				}
+				int begin = cellStart[row * cols + col];
+				int end = cellStart[row * cols + col + 1];
+				forEachDistance(center, begin, end, [&](int i, float distSq) {
+					Entity candidate = entities[i];
+					if (distSq <= bestSq && (unsigned int)candidate != selfId && (type == nullptr || type->has(candidate))) {
+						bestSq = distSq;
+						best = i;
+					}
+				});
+			}
+		}
+		// anything beyond this ring is at least ring * cellSize away from the center
+		float reach = ring * cellSize;
+		if (reach * reach > bestSq) {
+			break;
+		}
+	}
+	if (best < 0) {
+		return false;
+	}
+	out = entities[best];
+	return true;
+}
+
+void SpatialQuery::findNearestK(vec2 center, int k, float maxRadius, ContainerInterface* type, Candidates& scratch, std::vector<Entity>& out) const {
+	out.clear();
+	scratch.clear();
+	forEachInRadius(center, maxRadius, type, [&](int i, float distSq) {
+		scratch.push_back({ distSq, i });
+	});
+	int count = std::min(k, (int)scratch.size());
+	std::partial_sort(scratch.begin(), scratch.begin() + count, scratch.end());
+	for (int i = 0; i < count; i++) {
+		out.push_back(entities[scratch[i].second]);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// stlib
+#include <vector>
+
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// Default bucket size in unscaled pixels, about the spread out and chase avoid radii
+const float SPATIAL_CELL_SIZE = 128.f;
+// Upper bound on the number of buckets, the cell size grows when the agents are spread wider
+const int SPATIAL_MAX_CELLS = 4096;
+
+// Uniform grid over the positions of every enemy and active player, rebuilt once per AI step.
+// Agents are stored sorted by bucket as plain x / y arrays so the distance loops over a bucket
+// run on contiguous floats and vectorize. Every query compares squared distances.
+// A query can be restricted to one kind of agent by passing its registry container, e.g.
+// &registry.enemySwarms, or nullptr for every agent. Queries do not modify the grid and only
+// write to buffers owned by the caller, so the AI workers can run them at the same time
+class SpatialQuery
+{
+public:
+	// (distSq, agent index) pairs findNearestK ranks, kept by the caller so queries do not allocate
+	typedef std::vector<std::pair<float, int>> Candidates;
+
+	void build(float cellSize);
+
+	// Every agent within radius of center
+	void queryRadius(vec2 center, float radius, ContainerInterface* type, std::vector<Entity>& out) const;
+	// Closest agent within maxRadius of center other than self, false when there is none
+	bool findNearest(vec2 center, float maxRadius, ContainerInterface* type, Entity self, Entity& out) const;
+	// Up to k closest agents within maxRadius, closest first
+	void findNearestK(vec2 center, int k, float maxRadius, ContainerInterface* type, Candidates& scratch, std::vector<Entity>& out) const;
+
+	int size() const { return (int)xs.size(); };
+
+private:
+	float cellSize = 0;
+	vec2 origin = { 0, 0 };
+	int cols = 0;
+	int rows = 0;
+	// agents of bucket i are [cellStart[i], cellStart[i + 1])
+	std::vector<int> cellStart;
+	std::vector<float> xs;
+	std::vector<float> ys;
+	std::vector<Entity> entities;
+	// build scratch reused between steps
+	std::vector<vec2> positions;
+	std::vector<Entity> unsorted;
+	std::vector<int> entryCell;
+	std::vector<int> order;
+	std::vector<int> fill;
+
+	ivec2 cellOf(vec2 position) const;
+	// Calls visit(index, distSq) for every agent in [begin, end), the agents of one or more
+	// consecutive buckets. Distances are computed a chunk at a time into a stack buffer
+	template <typename Visit>
+	void forEachDistance(vec2 center, int begin, int end, Visit visit) const;
+	// Calls visit(index, distSq) for every agent of the given type within radius
+	template <typename Visit>
+	void forEachInRadius(vec2 center, float radius, ContainerInterface* type, Visit visit) const;
+};
@@ -0,0 +1,73 @@
+// internal
+#include "sprite_batch.hpp"
+
+// stlib
+#include <cstddef>
+
+// Per-instance float attribute, advancing once per sprite
+static void instanceAttribute(GLuint location, int size, size_t offset)
+{
+	glEnableVertexAttribArray(location);
+	glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offset);
+	glVertexAttribDivisor(location, 1);
+}
+
+void SpriteBatch::init(GLuint quad_vbo, GLuint quad_ibo)
+{
+	instances.reserve(SPRITE_BATCH_CAPACITY);
+
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	gl_has_errors();
+
+	// Locations 0 and 1, the SPRITE quad shared by every instance
+	glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex), (void*)sizeof(vec3));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quad_ibo);
+	gl_has_errors();
+
+	// Locations 2 to 11, refilled by every flush
+	glGenBuffers(1, &instance_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(SpriteInstance) * SPRITE_BATCH_CAPACITY, nullptr, GL_STREAM_DRAW);
+	instanceAttribute(2, 2, offsetof(SpriteInstance, position));
+	instanceAttribute(3, 2, offsetof(SpriteInstance, scale));
+	instanceAttribute(4, 1, offsetof(SpriteInstance, angle));
+	glEnableVertexAttribArray(5);
+	glVertexAttribIPointer(5, 1, GL_INT, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, flags));
+	glVertexAttribDivisor(5, 1);
+	instanceAttribute(6, 4, offsetof(SpriteInstance, frame));
+	instanceAttribute(7, 3, offsetof(SpriteInstance, tint));
+	instanceAttribute(8, 1, offsetof(SpriteInstance, colorScale));
+	instanceAttribute(9, 2, offsetof(SpriteInstance, hitVelocity));
+	instanceAttribute(10, 1, offsetof(SpriteInstance, hitDamage));
+	instanceAttribute(11, 1, offsetof(SpriteInstance, animationTime));
+	gl_has_errors();
+}
+
+void SpriteBatch::destroy()
+{
+	glDeleteBuffers(1, &instance_vbo);
+	glDeleteVertexArrays(1, &vao);
+	gl_has_errors();
+}
+
+void SpriteBatch::begin(EFFECT_ASSET_ID effect, GLuint texture)
+{
+	assert(empty());
+	runEffect = effect;
+	runTexture = texture;
+}
+
+void SpriteBatch::upload()
+{
+	assert(!empty());
+	glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+	// Orphan the old storage so the driver does not wait on the previous flush still reading it
+	glBufferData(GL_ARRAY_BUFFER, sizeof(SpriteInstance) * SPRITE_BATCH_CAPACITY, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(SpriteInstance) * instances.size(), instances.data());
+	gl_has_errors();
+}
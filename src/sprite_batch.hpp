@@ -0,0 +1,77 @@
+#pragma once
+
+// stlib
+#include <vector>
+
+#include "common.hpp"
+#include "components.hpp"
+
+// Sprites one instanced draw can hold, a longer run is flushed early
+const int SPRITE_BATCH_CAPACITY = 1024;
+
+// Bits of SpriteInstance::flags, the per-entity switches of the batch shaders
+const int SPRITE_FLAG_INVINCIBLE = 1 << 0;
+const int SPRITE_FLAG_DEAD = 1 << 1;
+const int SPRITE_FLAG_CUT = 1 << 2;
+// ignores the shop lighting
+const int SPRITE_FLAG_UNLIT = 1 << 3;
+
+// Per-instance attributes of one sprite, the vertex shader builds the transform from them.
+// Attribute locations are fixed by the layout qualifiers of the batch shaders
+struct SpriteInstance
+{
+	vec2 position = { 0.f, 0.f };
+	vec2 scale = { 1.f, 1.f };
+	float angle = 0.f;
+	int flags = 0;
+	// sub-rectangle of the texture the quad samples: u, v, width, height
+	vec4 frame = { 0.f, 0.f, 1.f, 1.f };
+	vec3 tint = { 1.f, 1.f, 1.f };
+	// enemy effect inputs, ignored by the plain sprite shader
+	float colorScale = 0.f;
+	vec2 hitVelocity = { 0.f, 0.f };
+	float hitDamage = 0.f;
+	float animationTime = 0.f;
+};
+
+// Accumulates SPRITE instances that share an effect and a GL texture, so sprites packed on the same
+// atlas page join one run, into one instance stream drawn with a single glDrawElementsInstanced
+// over the SPRITE quad.
+// The render system decides what can be batched and issues the draw, this only owns the stream
+class SpriteBatch
+{
+public:
+	// Needs a current GL context and the SPRITE geometry buffers
+	void init(GLuint quad_vbo, GLuint quad_ibo);
+	void destroy();
+
+	bool empty() const { return instances.empty(); };
+	bool full() const { return instances.size() == SPRITE_BATCH_CAPACITY; };
+	int size() const { return (int)instances.size(); };
+	// True when a sprite can join the run being accumulated
+	bool continuesRun(EFFECT_ASSET_ID effect, GLuint texture) const {
+		return !empty() && effect == runEffect && texture == runTexture;
+	};
+	EFFECT_ASSET_ID getEffect() const { return runEffect; };
+	GLuint getTexture() const { return runTexture; };
+
+	// Starts a new run, the previous one must have been flushed
+	void begin(EFFECT_ASSET_ID effect, GLuint texture);
+	void push(const SpriteInstance& instance) {
+		assert(!full());
+		instances.push_back(instance);
+	};
+	// VAO holding the quad and instance layout
+	GLuint getVertexArray() const { return vao; };
+	// Uploads the run into the instance stream, the caller draws size() instances with the VAO bound
+	void upload();
+	void clear() { instances.clear(); };
+
+private:
+	std::vector<SpriteInstance> instances;
+	EFFECT_ASSET_ID runEffect = EFFECT_ASSET_ID::EFFECT_COUNT;
+	GLuint runTexture = 0;
+
+	GLuint vao = 0;
+	GLuint instance_vbo = 0;
+};
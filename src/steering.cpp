@@ -0,0 +1,117 @@
+// internal
+#include "steering.hpp"
+#include "ai_lod.hpp"
+
+// stlib
+#include <algorithm>
+#include <cmath>
+
+void SteeringBatch::push(Entity agent, vec2 position, vec2 target, float direction, float normalized, float agentSpeed) {
+	agents.push_back(agent);
+	px.push_back(position.x);
+	py.push_back(position.y);
+	tx.push_back(target.x);
+	ty.push_back(target.y);
+	sign.push_back(direction);
+	normalize.push_back(normalized);
+	speed.push_back(agentSpeed);
+}
+
+void SteeringBatch::seek(Entity agent, vec2 position, vec2 target, float speed) {
+	push(agent, position, target, 1.f, 1.f, speed);
+}
+
+void SteeringBatch::flee(Entity agent, vec2 position, vec2 threat, float speed) {
+	push(agent, position, threat, -1.f, 1.f, speed);
+}
+
+void SteeringBatch::separate(Entity agent, vec2 position, vec2 neighbour, float speed) {
+	flee(agent, position, neighbour, speed);
+}
+
+void SteeringBatch::wander(Entity agent, vec2 direction, float speed) {
+	push(agent, vec2(0, 0), direction, 1.f, 0.f, speed);
+}
+
+void SteeringBatch::setVelocity(Entity agent, vec2 velocity) {
+	wander(agent, velocity, 1.f);
+}
+
+// The arrays never overlap. GCC only trusts __restrict on parameters, so the loop lives in its own
+// function to spare it the alias checks that would otherwise stop it from vectorizing
+static void steeringKernel(int count, const float* __restrict pX, const float* __restrict pY,
+	const float* __restrict tX, const float* __restrict tY, const float* __restrict s,
+	const float* __restrict n, const float* __restrict v, float* __restrict outX, float* __restrict outY) {
+	for (int i = 0; i < count; i++) {
+		float dx = (tX[i] - pX[i]) * s[i];
+		float dy = (tY[i] - pY[i]) * s[i];
+		float lengthSq = dx * dx + dy * dy;
+		// biased instead of branching, an agent already on its target has a zero offset and stops anyway
+		float invLength = 1.f / std::sqrt(lengthSq + 1e-12f);
+		float scale = (n[i] * invLength + (1.f - n[i])) * v[i];
+		outX[i] = dx * scale;
+		outY[i] = dy * scale;
+	}
+}
+
+void SteeringBatch::evaluate() {
+	vx.resize(size());
+	vy.resize(size());
+	steeringKernel(size(), px.data(), py.data(), tx.data(), ty.data(), sign.data(), normalize.data(), speed.data(), vx.data(), vy.data());
+}
+
+void SteeringBatch::evaluateReference(std::vector<vec2>& out) const {
+	out.clear();
+	for (int i = 0; i < size(); i++) {
+		vec2 diff = (vec2(tx[i], ty[i]) - vec2(px[i], py[i])) * sign[i];
+		if (normalize[i] == 0.f) {
+			out.push_back(diff * speed[i]);
+		}
+		else if (diff == vec2(0, 0)) {
+			out.push_back(vec2(0, 0));
+		}
+		else {
+			float angle = atan2(diff.y, diff.x);
+			out.push_back(vec2(cos(angle) * speed[i], sin(angle) * speed[i]));
+		}
+	}
+}
+
+float SteeringBatch::maxReferenceError() const {
+	std::vector<vec2> reference;
+	evaluateReference(reference);
+	float maxError = 0.f;
+	for (int i = 0; i < size(); i++) {
+		vec2 diff = vec2(vx[i], vy[i]) - reference[i];
+		float magnitude = std::max(length(reference[i]), 1.f);
+		maxError = std::max(maxError, length(diff) / magnitude);
+	}
+	return maxError;
+}
+
+void SteeringBatch::apply() {
+	for (int i = 0; i < size(); i++) {
+		// the agent may have been removed after its request was made
+		if (!registry.motions.has(agents[i])) {
+			continue;
+		}
+		// a frozen agent stays still and picks the request up when it thaws
+		if (getAILodTier(agents[i]) == AI_LOD_TIER::FROZEN) {
+			registry.aiLods.get(agents[i]).thawVelocity = vec2(vx[i], vy[i]);
+		}
+		else {
+			registry.motions.get(agents[i]).velocity = vec2(vx[i], vy[i]);
+		}
+	}
+}
+
+void SteeringBatch::clear() {
+	agents.clear();
+	px.clear();
+	py.clear();
+	tx.clear();
+	ty.clear();
+	sign.clear();
+	normalize.clear();
+	speed.clear();
+}
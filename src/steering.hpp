@@ -0,0 +1,53 @@
+#pragma once
+
+// stlib
+#include <vector>
+
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// Relative velocity error allowed between the batched kernel and the trig reference
+const float STEERING_REFERENCE_TOLERANCE = 1e-3f;
+
+// Collects steering requests from every agent during the AI step and resolves them together.
+// Requests are stored as structure of arrays and evaluate() turns them into velocities in one
+// branch free loop, normalizing with a reciprocal square root instead of atan2 / cos / sin, so
+// the compiler can vectorize it. apply() then writes the velocities back in request order, so a
+// later request for the same agent wins like a direct assignment would
+class SteeringBatch
+{
+public:
+	// Move toward target at speed
+	void seek(Entity agent, vec2 position, vec2 target, float speed);
+	// Move directly away from threat at speed
+	void flee(Entity agent, vec2 position, vec2 threat, float speed);
+	// Keep away from a neighbour, same as fleeing from it
+	void separate(Entity agent, vec2 position, vec2 neighbour, float speed);
+	// Move along direction scaled by speed without normalizing, used for random wandering
+	void wander(Entity agent, vec2 direction, float speed);
+	// Use velocity as is
+	void setVelocity(Entity agent, vec2 velocity);
+
+	void evaluate();
+	// Scalar atan2 / cos / sin version of evaluate, kept to validate the kernel against
+	void evaluateReference(std::vector<vec2>& out) const;
+	// Largest difference between evaluate and evaluateReference relative to the requested speed
+	float maxReferenceError() const;
+
+	void apply();
+	void clear();
+	int size() const { return (int)agents.size(); };
+
+private:
+	std::vector<Entity> agents;
+	std::vector<float> px, py;
+	std::vector<float> tx, ty;
+	// 1 to move toward the target, -1 to move away from it
+	std::vector<float> sign;
+	// 1 to normalize the offset before scaling by speed, 0 to use it as is
+	std::vector<float> normalize;
+	std::vector<float> speed;
+	std::vector<float> vx, vy;
+
+	void push(Entity agent, vec2 position, vec2 target, float direction, float normalized, float agentSpeed);
+};
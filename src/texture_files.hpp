@@ -0,0 +1,80 @@
+#pragma once
+
+// Files of data/textures in TEXTURE_ASSET_ID order, shared by the render system and the atlas
+// packer in tools/. Make sure this table remains in sync with the enumerators.
+// SOURCE for enemyrun.png: https://store.line.me/stickershop/product/1014536/en
+// SOURCE for enemy.png: https://www.klipartz.com/ru/search?q=%D0%B2%D0%B8%D1%80%D1%83%D1%81
+// SOURCE for enemychase.png: https://commons.wikimedia.org/wiki/File:Average_prokaryote_cell-_unlabled.svg
+// SOURCE for keys on help.png: https://support.apple.com/en-us/HT201236
+// SOURCE for tail: https://roblox.fandom.com/wiki/Catalog:Earth_Dragon_Tail
+
+struct TextureFile {
+	const char* name;
+	// Packed into the atlas when true. Full-screen art and the letter sheets, wider than a page,
+	// stay out and are loaded on their own
+	bool inAtlas;
+	// Opt-in downscale, the longest side the texture is resampled to in the atlas. 0 packs it at full
+	// resolution. Only set for sources far larger than the sprite is ever drawn, and never below the
+	// sprite's on-screen size at the largest resolution scaling (2x, 4K), so it is never magnified
+	int atlasDownscale;
+};
+
+const TextureFile texture_files[] = {
+	{ "tree_red.png", true, 280 },
+	{ "tree_orange.png", true, 280 },
+	{ "tree_yellow.png", true, 280 },
+	{ "waterball.png", true, 160 },
+	{ "wizard.png", true, 288 },
+	{ "wizard_disgust.png", true, 288 },
+	{ "enemy.png", true, 160 },
+	{ "enemyrun.png", true, 160 },
+	{ "hunter1.png", true, 160 },
+	{ "hunter2.png", true, 160 },
+	{ "hunter3.png", true, 160 },
+	{ "hunter4.png", true, 160 },
+	{ "help.png", false, 0 },
+	{ "yellow-bacteria.png", true, 192 },
+	{ "enemychase.png", true, 128 },
+	{ "knight.png", true, 0 },
+	{ "Frame_1.png", false, 0 },
+	{ "Frame_2.png", false, 0 },
+	{ "Frame_3.png", false, 0 },
+	{ "Frame_4.png", false, 0 },
+	{ "Frame_5.png", false, 0 },
+	{ "Frame_6.png", false, 0 },
+	{ "swarm1.png", true, 160 },
+	{ "swarm2.png", true, 160 },
+	{ "fireball.png", true, 160 },
+	{ "sword.png", true, 0 },
+	{ "wizard_attack.png", true, 864 },
+	{ "wizard_idle.png", true, 864 },
+	{ "wizard_walk.png", true, 576 },
+	{ "BTEnemy.png", true, 0 },
+	{ "main_menu.png", false, 0 },
+	{ "in_game_menu.png", false, 0 },
+	{ "HpUp.png", true, 160 },
+	{ "attackSpeedUp.png", true, 192 },
+	{ "movementUp.png", true, 160 },
+	{ "dmgUp.png", true, 192 },
+	{ "background_new.png", false, 0 },
+	{ "numbers.png", true, 0 },
+	{ "coin.png", true, 128 },
+	{ "hp.png", true, 128 },
+	{ "knightIcon.png", true, 0 },
+	{ "wizard_earring.png", true, 128 },
+	{ "caps_letters.png", false, 0 },
+	{ "small_letters.png", false, 0 },
+	{ "tutorial.png", false, 0 },
+	{ "shop-arrow.png", true, 176 },
+	{ "AStarEnemy.png", true, 160 },
+	{ "bg_final.png", false, 0 },
+	{ "hand.png", true, 0 },
+	{ "minion.png", true, 192 },
+	{ "minioncrazy.png", true, 192 },
+	{ "bossfireball.png", true, 0 },
+	{ "boss.png", true, 0 },
+	{ "enemyhead.png", true, 224 },
+	{ "enemytail.png", true, 224 },
+	{ "end_1.png", false, 0 },
+	{ "end_2.png", false, 0 }
+};
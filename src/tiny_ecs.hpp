@@ -65,6 +65,24 @@ public:
 		return components.back();
 	};
 
+	// Inserting a copy of c for every entity in batch, growing the storage once
+	// Returns the index of the first new component, the batch occupies the next batch.size() slots
+	unsigned int insertBatch(const std::vector<Entity>& batch, const Component& c)
+	{
+		unsigned int first = (unsigned int)components.size();
+		components.reserve(components.size() + batch.size());
+		entities.reserve(entities.size() + batch.size());
+		map_entity_componentID.reserve(map_entity_componentID.size() + batch.size());
+		for (Entity e : batch)
+		{
+			assert(!has(e) && "Entity already contained in ECS registry");
+			map_entity_componentID[e] = (unsigned int)components.size();
+			components.push_back(c);
+			entities.push_back(e);
+		}
+		return first;
+	};
+
 	// The emplace function takes the the provided arguments Args, creates a new object of type Component, and inserts it into the ECS system
 	template<typename... Args>
 	Component& emplace(Entity e, Args &&... args) {
@@ -78,7 +96,14 @@ public:
 	// A wrapper to return the component of an entity
 	Component& get(Entity e) {
 		assert(has(e) && "Entity not contained in ECS registry");
-		return components[map_entity_componentID[e]];
+		// find instead of [] so concurrent lookups from the AI workers only read the map
+		return components[map_entity_componentID.find(e)->second];
+	}
+
+	// The component of an entity, or nullptr if it has none, with a single hash lookup
+	Component* find(Entity e) {
+		auto it = map_entity_componentID.find(e);
+		return it == map_entity_componentID.end() ? nullptr : &components[it->second];
 	}
 
 	// Check if entity has a component of type 'Component'
@@ -15,11 +15,13 @@ public:
 	ComponentContainer<TutorialTimer> tutorialTimers; 
 	ComponentContainer<Motion> motions;
 	ComponentContainer<Collision> collisions;
+	ComponentContainer<Collider> colliders;
 	ComponentContainer<Player> players;
 	ComponentContainer<PlayerStat> playerStats;
 	ComponentContainer<DeadPlayer> deadPlayers;
 	ComponentContainer<Mesh*> meshPtrs;
 	ComponentContainer<RenderRequest> renderRequests;
+	ComponentContainer<RenderLayer> renderLayers;
 	ComponentContainer<ScreenState> screenStates;
 	ComponentContainer<DebugComponent> debugComponents;
 	ComponentContainer<MouseDestination> mouseDestinations;
@@ -28,6 +30,7 @@ public:
 	ComponentContainer<Block> blocks;
 	ComponentContainer<Wall> walls;
 	ComponentContainer<Door> doors;
+	ComponentContainer<NavGrid> navGrids;
 	ComponentContainer<vec3> colors;
 	ComponentContainer<Enemy> enemies;
 	ComponentContainer<DeadEnemy> deadEnemies;
@@ -37,6 +40,9 @@ public:
 	ComponentContainer<EnemyHunter> enemyHunters;
 	ComponentContainer<EnemyBacteria> enemyBacterias;
 	ComponentContainer<EnemyGerm> enemyGerms;
+	ComponentContainer<BTBlackboard> btBlackboards;
+	ComponentContainer<AIThink> aiThinks;
+	ComponentContainer<AILod> aiLods;
 	ComponentContainer<EnemyChase> enemyChase;
 	ComponentContainer<EnemySwarm> enemySwarms;
 	ComponentContainer<EnemyCoordHead> enemyCoordHeads;
@@ -74,11 +80,13 @@ public:
 		registry_list.push_back(&tutorialTimers); 
 		registry_list.push_back(&motions);
 		registry_list.push_back(&collisions);
+		registry_list.push_back(&colliders);
 		registry_list.push_back(&players);
 		registry_list.push_back(&playerStats);
 		registry_list.push_back(&deadPlayers);
 		registry_list.push_back(&meshPtrs);
 		registry_list.push_back(&renderRequests);
+		registry_list.push_back(&renderLayers);
 		registry_list.push_back(&screenStates);
 		registry_list.push_back(&debugComponents);
 		registry_list.push_back(&mouseDestinations);
@@ -87,6 +95,7 @@ public:
 		registry_list.push_back(&blocks);
 		registry_list.push_back(&walls);
 		registry_list.push_back(&doors);
+		registry_list.push_back(&navGrids);
 		registry_list.push_back(&colors);
 		registry_list.push_back(&enemies);
 		registry_list.push_back(&deadEnemies);
@@ -96,6 +105,9 @@ public:
 		registry_list.push_back(&enemyHunters);
 		registry_list.push_back(&enemyBacterias);
 		registry_list.push_back(&enemyGerms);
+		registry_list.push_back(&btBlackboards);
+		registry_list.push_back(&aiThinks);
+		registry_list.push_back(&aiLods);
 		registry_list.push_back(&enemyChase);
 		registry_list.push_back(&enemySwarms);
 		registry_list.push_back(&enemyCoordHeads);
@@ -0,0 +1,89 @@
+// internal
+#include "worker_pool.hpp"
+
+WorkerPool::WorkerPool(int threadCount) {
+	nextJob = 0;
+	startThreads(threadCount);
+}
+
+WorkerPool::~WorkerPool() {
+	stopThreads();
+}
+
+int WorkerPool::defaultThreadCount() {
+	int hardwareThreads = (int)std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+void WorkerPool::setThreadCount(int threadCount) {
+	stopThreads();
+	startThreads(threadCount);
+}
+
+void WorkerPool::startThreads(int threadCount) {
+	quitting = false;
+	for (int i = 0; i < threadCount; i++) {
+		// hand over the current batch number so a batch started before the thread runs is not missed
+		threads.emplace_back(&WorkerPool::workerLoop, this, batch);
+	}
+}
+
+void WorkerPool::stopThreads() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quitting = true;
+	}
+	wake.notify_all();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+}
+
+void WorkerPool::runJobs() {
+	for (int i = nextJob++; i < currentJobCount; i = nextJob++) {
+		(*currentJob)(i);
+	}
+}
+
+void WorkerPool::run(int jobCount, const std::function<void(int)>& job) {
+	if (threads.empty() || jobCount <= 1) {
+		for (int i = 0; i < jobCount; i++) {
+			job(i);
+		}
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		currentJob = &job;
+		currentJobCount = jobCount;
+		nextJob = 0;
+		busyWorkers = (int)threads.size();
+		batch++;
+	}
+	wake.notify_all();
+	runJobs();
+	// every worker has to leave the batch before job goes out of scope
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this]() { return busyWorkers == 0; });
+	currentJob = nullptr;
+}
+
+void WorkerPool::workerLoop(unsigned int seenBatch) {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() { return quitting || batch != seenBatch; });
+			if (quitting) {
+				return;
+			}
+			seenBatch = batch;
+		}
+		runJobs();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			busyWorkers--;
+		}
+		finished.notify_one();
+	}
+}
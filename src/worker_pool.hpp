@@ -0,0 +1,46 @@
+#pragma once
+
+// stlib
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads that run batches of independent jobs. The calling thread works on the
+// batch too, so a pool with 0 threads simply runs every job in order on the caller
+class WorkerPool
+{
+public:
+	WorkerPool(int threadCount = defaultThreadCount());
+	~WorkerPool();
+
+	// Runs job(0) .. job(jobCount - 1) and returns once all of them finished
+	void run(int jobCount, const std::function<void(int)>& job);
+
+	// Stops the current threads and starts threadCount new ones, must not be called during run
+	void setThreadCount(int threadCount);
+	int getThreadCount() const { return (int)threads.size(); };
+
+	// One less than the hardware threads, the caller is the last one
+	static int defaultThreadCount();
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	// the batch being run, workers claim jobs by incrementing nextJob
+	const std::function<void(int)>* currentJob = nullptr;
+	int currentJobCount = 0;
+	std::atomic<int> nextJob;
+	int busyWorkers = 0;
+	unsigned int batch = 0;
+	bool quitting = false;
+
+	void startThreads(int threadCount);
+	void stopThreads();
+	void workerLoop(unsigned int seenBatch);
+	void runJobs();
+};
@@ -1,12 +1,6 @@
 #include "world_init.hpp"
 #include "tiny_ecs_registry.hpp"
 
-#include <random>
-
-// Seeding rng with random device
-std::default_random_engine rng = std::default_random_engine(std::random_device()());
-std::uniform_real_distribution<float> uniform_dist;
-
 Entity createBackground(RenderSystem* renderer, vec2 position) {
 	// Reserve en entity
 	auto entity = Entity();
@@ -23,6 +17,7 @@ Entity createBackground(RenderSystem* renderer, vec2 position) {
 	motion.scale = vec2({ BACKGROUND_BB_WIDTH * defaultResolution.scaling, BACKGROUND_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.backgrounds.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::BACKGROUND });
 	registry.renderRequests.insert(
 		entity,
 		{ TEXTURE_ASSET_ID::BACKGROUND,
@@ -47,6 +42,7 @@ Entity createFinalBackground(RenderSystem* renderer, vec2 position) {
 	motion.scale = vec2({ BACKGROUND_BB_WIDTH * defaultResolution.scaling, BACKGROUND_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.backgrounds.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::BACKGROUND });
 	registry.renderRequests.insert(
 		entity,
 		{ TEXTURE_ASSET_ID::FINALBACKGROUND,
@@ -74,6 +70,8 @@ Entity createWizard(RenderSystem* renderer, vec2 position) {
 	motion.scale = vec2({ WIZARD_BB_WIDTH * defaultResolution.scaling, WIZARD_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.players.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::PLAYER });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PLAYER });
 	animation.animationMode = animation.idleMode;
 	registry.renderRequests.insert(
 		entity,
@@ -102,6 +100,8 @@ Entity createKnight(RenderSystem* renderer, vec2 position) {
 	motion.scale = vec2({ KNIGHT_BB_WIDTH * defaultResolution.scaling, KNIGHT_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.players.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::PLAYER });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PLAYER });
 	registry.renderRequests.insert(
 		entity,
 		{ TEXTURE_ASSET_ID::KNIGHT,
@@ -129,6 +129,8 @@ Entity createSword(RenderSystem* renderer, float angle, Entity playerEntity) {
 	motion.scale = vec2({ SWORD_BB_WIDTH * defaultResolution.scaling, SWORD_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.swords.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::SWORD });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PROJECTILE });
 	registry.swords.get(entity).belongToPlayer = playerEntity;
 	registry.renderRequests.insert(
 		entity,
@@ -143,6 +145,7 @@ Entity createSword(RenderSystem* renderer, float angle, Entity playerEntity) {
 Entity createWall(vec2 position, vec2 scale) {
 	Entity entity = Entity();
 	Wall& wall = registry.walls.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::TERRAIN });
 
 	registry.renderRequests.insert(
 		entity,
@@ -164,6 +167,7 @@ Entity createDoor(vec2 position, vec2 scale) {
 	Entity entity = Entity();
 	Wall& wall = registry.walls.emplace(entity);
 	Door& door = registry.doors.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::TERRAIN });
 
 	registry.renderRequests.insert(
 		entity,
@@ -204,6 +208,7 @@ Entity createBlock(RenderSystem* renderer, vec2 pos, std::string color) {
 	else if (color == "yellow") blockColor = TEXTURE_ASSET_ID::TREE_YELLOW;
 
 	registry.blocks.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::TERRAIN });
 	registry.renderRequests.insert(
 		entity,
 		{   blockColor,
@@ -213,549 +218,6 @@ Entity createBlock(RenderSystem* renderer, vec2 pos, std::string color) {
 	return entity;
 }
 
-Entity createEnemy(RenderSystem* renderer, vec2 position, int enemyType) {
-	Entity curEnemy;
-	switch (enemyType) {
-		case 0:
-			curEnemy = createEnemyBlob(renderer, position);
-			break;
-		case 1:
-			curEnemy = createEnemyRun(renderer, position);
-			break;
-		case 2:
-			curEnemy = createEnemyHunter(renderer, position);
-			break;
-		case 3:
-			curEnemy = createEnemyBacteria(renderer, position);
-			break;
-		case 4:
-			curEnemy = createEnemyChase(renderer, position);
-			break;
-		case 5:
-			curEnemy = createEnemySwarmTriplet(renderer, position);
-			break;
-		case 6:
-			curEnemy = createEnemyGerm(renderer, position);
-			break;
-		case 7: 
-			curEnemy = createTutorialEnemy(renderer, position); 
-			break;
-		case 8:
-			curEnemy = createEnemyAStar(renderer, position);
-			break;
-		case 9:  
-			curEnemy = createEnemyMinions(renderer, position); 
-			break;
-		case 10:
-			curEnemy = createEnemyBossHand(renderer, position);
-			break;
-		case 11:
-			curEnemy = createEnemyBoss(renderer, position);
-			break;
-		case 12:
-			curEnemy = createEnemyCoordHead(renderer, position);
-			break;
-		case 13:
-			curEnemy = createEnemyCoordTail(renderer, position);
-			break;
-	}
-	return curEnemy;
-}
-
-Entity createEnemyBlob(RenderSystem* renderer, vec2 position)
-{
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-	Mesh& hitbox = renderer->getMesh(GEOMETRY_BUFFER_ID::BLOBBER);
-	registry.hitboxes.emplace(entity, &hitbox);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-
-	motion.scale = vec2({ ENEMYBLOB_BB_WIDTH * defaultResolution.scaling, ENEMYBLOB_BB_HEIGHT * defaultResolution.scaling });
-
-	registry.enemies.emplace(entity);
-	registry.enemyBlobs.emplace(entity);
-	// Set enemy attributes
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 3;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 2;
-	enemyCom.speed = 200.f * defaultResolution.scaling;
-	motion.velocity = vec2(0.f, enemyCom.speed);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMY,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
-Entity createTutorialEnemy(RenderSystem* renderer, vec2 position)
-{
-	// Reserve an entity
-	auto entity = Entity();
-
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-	Mesh& hitbox = renderer->getMesh(GEOMETRY_BUFFER_ID::BLOBBER);
-	registry.hitboxes.emplace(entity, &hitbox);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-	motion.velocity = vec2(0.f, 0.f); 
-
-	motion.scale = vec2({ ENEMYBLOB_BB_WIDTH * defaultResolution.scaling, ENEMYBLOB_BB_HEIGHT * defaultResolution.scaling });
-
-	registry.enemies.emplace(entity);
-	registry.enemiesTutorial.emplace(entity);
-	// Set enemy attributes
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 5;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 5;
-	enemyCom.speed = 0.f;
-	enemyCom.invinFrame = 7000.f; 
-	enemyCom.isInvin = true; 
-
-	return entity;
-}
-
-Entity createEnemyRun(RenderSystem* renderer, vec2 position)
-{
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-	Mesh& hitbox = renderer->getMesh(GEOMETRY_BUFFER_ID::RUNNER);
-	registry.hitboxes.emplace(entity, &hitbox);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-
-	motion.scale = vec2({ ENEMYRUN_BB_WIDTH * defaultResolution.scaling, ENEMYRUN_BB_HEIGHT * defaultResolution.scaling });
-
-	registry.enemies.emplace(entity);
-	registry.enemiesrun.emplace(entity);
-	// Set enemy attributes
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 3;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 2;
-	enemyCom.speed = 150.f * defaultResolution.scaling;
-	motion.velocity = vec2(uniform_dist(rng) * enemyCom.speed, uniform_dist(rng) * enemyCom.speed);;
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMYRUN,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
-Entity createEnemyHunter(RenderSystem* renderer, vec2 position) {
-	auto entity = Entity();
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-	Mesh& hitbox = renderer->getMesh(GEOMETRY_BUFFER_ID::HUNTER);
-	registry.hitboxes.emplace(entity, &hitbox);
-
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.velocity = vec2(0, 0);
-	motion.position = position;
-
-	motion.scale = vec2({ ENEMYHUNTER_BB_WIDTH * defaultResolution.scaling, ENEMYHUNTER_BB_HEIGHT * defaultResolution.scaling });
-
-	registry.enemies.emplace(entity);
-	registry.enemyHunters.emplace(entity);
-	// Set enemy attributes
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 6;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 2;
-	enemyCom.speed = 150.f * defaultResolution.scaling;
-	auto& hunterCom = registry.enemyHunters.get(entity);
-	hunterCom.currentState = hunterCom.searchingMode;
-	hunterCom.huntingRange = hunterCom.huntingRange * defaultResolution.scaling;
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMYHUNTER,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
-Entity createEnemyBacteria(RenderSystem* renderer, vec2 position) {
-	auto entity = Entity();
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-	Mesh& hitbox = renderer->getMesh(GEOMETRY_BUFFER_ID::BACTERIA);
-	registry.hitboxes.emplace(entity, &hitbox);
-
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.velocity = vec2(0, 0);
-	motion.position = position;
-
-	motion.scale = vec2({ ENEMYBACTERIA_BB_WIDTH * defaultResolution.scaling, ENEMYBACTERIA_BB_HEIGHT * defaultResolution.scaling });
-
-	registry.enemies.emplace(entity);
-	registry.enemyBacterias.emplace(entity);
-	// Set enemy attributes
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 6;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 2;
-	enemyCom.speed = 150.f * defaultResolution.scaling;
-	auto& bacteria = registry.enemyBacterias.get(entity);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMYBACTERIA,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
-Entity createEnemyGerm(RenderSystem* renderer, vec2 position) {
-	auto entity = Entity();
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-	Mesh& hitbox = renderer->getMesh(GEOMETRY_BUFFER_ID::GERM);
-	registry.hitboxes.emplace(entity, &hitbox);
-
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.velocity = vec2(0, 0);
-	motion.position = position;
-
-	motion.scale = vec2({ ENEMYGERM_BB_WIDTH * defaultResolution.scaling, ENEMYGERM_BB_HEIGHT * defaultResolution.scaling });
-	
-	registry.enemies.emplace(entity);
-	registry.enemyGerms.emplace(entity);
-	// Set enemy attributes
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 7;
-	enemyCom.loot = 2;
-	enemyCom.speed = 125.f * defaultResolution.scaling;
-	auto& germ = registry.enemyGerms.get(entity);
-	germ.mode = (rand() % 10) + 1;
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::GERM,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
-Entity createEnemyAStar(RenderSystem* renderer, vec2 position) {
-	auto entity = Entity();
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.velocity = vec2(0, 0);
-	motion.position = position;
-
-	motion.scale = vec2({ ENEMYASTAR_BB_WIDTH * defaultResolution.scaling, ENEMYASTAR_BB_HEIGHT * defaultResolution.scaling });
-
-	registry.enemies.emplace(entity);
-	registry.enemyAStars.emplace(entity);
-	// Set enemy attributes
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 8;
-	enemyCom.loot = 2;
-	enemyCom.speed = 200.f * defaultResolution.scaling;
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMYASTAR,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
-// Enemy that chases the player
-Entity createEnemyChase(RenderSystem* renderer, vec2 position)
-{
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-
-	motion.scale = vec2({ ENEMYCHASE_BB_WIDTH * defaultResolution.scaling, ENEMYCHASE_BB_HEIGHT * defaultResolution.scaling });
-
-	registry.enemies.emplace(entity);
-	registry.enemyChase.emplace(entity);
-	// Set enemy attributes
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 3;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 1;
-	enemyCom.speed = 50.f * defaultResolution.scaling;
-	motion.velocity = vec2(uniform_dist(rng) * enemyCom.speed, uniform_dist(rng) * enemyCom.speed);
-
-	Motion& player_motion = motion;
-	for (Entity player : registry.players.entities) {
-		player_motion = registry.motions.get(entity);
-		break;
-	}
-
-	vec2 enemy_to_player = vec2(player_motion.position.x - motion.position.x, player_motion.position.y - motion.position.y);
-	float radians = atan2f(enemy_to_player.y, -enemy_to_player.x);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMYCHASE,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
-Entity createEnemySwarmTriplet(RenderSystem* renderer, vec2 position)
-{
-	// Reserve en entity
-	auto entity = createEnemySwarm(renderer, position);
-	float swarmSpawnGap = 60.f;
-	vec2 enemyTwoPosition = vec2(position.x + (swarmSpawnGap * defaultResolution.scaling), position.y - (swarmSpawnGap * defaultResolution.scaling));
-	createEnemySwarm(renderer, enemyTwoPosition);
-	vec2 enemyThreePosition = vec2(position.x + (swarmSpawnGap * defaultResolution.scaling), position.y + (swarmSpawnGap * defaultResolution.scaling));
-	createEnemySwarm(renderer, enemyThreePosition);
-
-	return entity;
-}
-
-Entity createEnemySwarm(RenderSystem* renderer, vec2 position) {
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-	motion.scale = vec2({ ENEMYSWARM_BB_WIDTH  * defaultResolution.scaling, ENEMYSWARM_BB_HEIGHT  * defaultResolution.scaling });
-	registry.enemies.emplace(entity);
-	// Set enemy attributes
-	EnemySwarm& swarm = registry.enemySwarms.emplace(entity);
-	swarm.projectileSpeed = swarm.projectileSpeed * defaultResolution.scaling;
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 6;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 2;
-	enemyCom.speed = 100.f * defaultResolution.scaling;
-	motion.velocity = vec2(0, 0);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMYSWARM,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-	return entity;
-}
-
-Entity createEnemyCoordHead(RenderSystem* renderer, vec2 position) {
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-	motion.scale = vec2({ ENEMYHEAD_BB_WIDTH * defaultResolution.scaling, ENEMYHEAD_BB_HEIGHT * defaultResolution.scaling });
-	auto& enemyCom = registry.enemies.emplace(entity);
-	// Set enemy attributes
-	auto& head = registry.enemyCoordHeads.emplace(entity);
-	head.minDistFromTail *= defaultResolution.scaling;
-	enemyCom.damage = 1;
-	enemyCom.hp = 15;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 4;
-	enemyCom.speed = 100.f * defaultResolution.scaling;
-	motion.velocity = vec2(0, 0);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMYHEAD,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-	return entity;
-}
-
-Entity createEnemyCoordTail(RenderSystem* renderer, vec2 position) {
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-	motion.scale = vec2({ ENEMYTAIL_BB_WIDTH * defaultResolution.scaling, ENEMYTAIL_BB_HEIGHT * defaultResolution.scaling });
-	registry.enemies.emplace(entity);
-	// Set enemy attributes
-	auto& tail = registry.enemyCoordTails.emplace(entity);
-	auto& enemyCom = registry.enemies.get(entity);
-	tail.minDistFromHead *= defaultResolution.scaling;
-	enemyCom.damage = 1;
-	enemyCom.hp = 100;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 0;
-	enemyCom.speed = 100.f * defaultResolution.scaling;
-	motion.velocity = vec2(0, 0);
-
-	// refer correct head to this tail
-	Entity headEntity = registry.enemyCoordHeads.entities[registry.enemyCoordTails.size() - 1];
-	registry.enemyCoordHeads.get(headEntity).belongToTail = entity;
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ENEMYTAIL,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-	return entity;
-}
-
-Entity createEnemyBoss(RenderSystem* renderer, vec2 position) {
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.position = position;
-	motion.scale = vec2({ BOSS_BB_WIDTH * defaultResolution.scaling, BOSS_BB_HEIGHT * defaultResolution.scaling });
-	auto& enemyCom = registry.enemies.emplace(entity);
-	registry.enemyBoss.emplace(entity);
-	// Set enemy attributes
-	enemyCom.damage = 1;
-	enemyCom.hp = 55;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 99;
-	enemyCom.speed = 0.f;
-	motion.velocity = vec2(0.f, 0.f);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::BOSS,
-			EFFECT_ASSET_ID::BOSS,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
-Entity createEnemyMinions(RenderSystem* renderer, vec2 position) {
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-	motion.scale = vec2({ ENEMYMINION_BB_WH * defaultResolution.scaling, ENEMYMINION_BB_WH * defaultResolution.scaling });
-	registry.enemies.emplace(entity);
-	// Set enemy attributes
-	EnemySwarm& swarm = registry.enemySwarms.emplace(entity);
-	swarm.projectileSpeed = swarm.projectileSpeed * defaultResolution.scaling;
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 11;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 2;
-	enemyCom.speed = 100.f * defaultResolution.scaling;
-	motion.velocity = vec2(0, 0);
-
-	return entity;
-}
-
-Entity createEnemyBossHand(RenderSystem* renderer, vec2 position) {
-	// Reserve en entity
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-
-	// Initialize the position, scale, and physics components
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.position = position;
-	motion.scale = vec2({ HAND_BB_WIDTH * defaultResolution.scaling, HAND_BB_HEIGHT * defaultResolution.scaling });
-	registry.enemies.emplace(entity);
-	// Set enemy attributes
-	EnemySwarm& hand = registry.enemySwarms.emplace(entity);
-	EnemyBossHand& boss = registry.enemyBossHand.emplace(entity);
-	hand.projectileSpeed = 300.f* defaultResolution.scaling;
-	auto& enemyCom = registry.enemies.get(entity);
-	enemyCom.damage = 1;
-	enemyCom.hp = 30;
-	enemyCom.max_hp = enemyCom.hp;
-	enemyCom.loot = 2;
-	enemyCom.speed = 400.f * defaultResolution.scaling;
-	motion.velocity = vec2(enemyCom.speed, 0);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::HAND,
-			EFFECT_ASSET_ID::ENEMY,
-			GEOMETRY_BUFFER_ID::SPRITE });
-
-	return entity;
-}
-
 Entity createProjectile(RenderSystem* renderer, vec2 pos, vec2 velocity, float angle, Entity playerEntity) {
 	// Reserve en entity
 	auto entity = Entity();
@@ -776,6 +238,8 @@ Entity createProjectile(RenderSystem* renderer, vec2 pos, vec2 velocity, float a
 	motion.scale = vec2({ WATERBALL_BB_WIDTH * defaultResolution.scaling, WATERBALL_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.projectiles.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::PROJECTILE });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PROJECTILE });
 	registry.projectiles.get(entity).belongToPlayer = playerEntity;
 	registry.renderRequests.insert(
 		entity,
@@ -804,6 +268,8 @@ Entity createEnemyProjectile(RenderSystem* renderer, vec2 pos, vec2 velocity, fl
 	motion.scale = vec2({ FIREBALL_BB_WIDTH * defaultResolution.scaling, FIREBALL_BB_HEIGHT * defaultResolution.scaling });
 
 	EnemyProjectile& projectile = registry.enemyProjectiles.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::ENEMY_PROJECTILE });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PROJECTILE });
 	projectile.belongToEnemy = enemyEntity;
 	registry.renderRequests.insert(
 		entity,
@@ -832,6 +298,8 @@ Entity createHandProjectile(RenderSystem* renderer, vec2 pos, vec2 velocity, flo
 	motion.scale = vec2({ FIREBALL_BB_WIDTH * defaultResolution.scaling, FIREBALL_BB_HEIGHT * defaultResolution.scaling });
 
 	EnemyProjectile& projectile = registry.enemyProjectiles.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::ENEMY_PROJECTILE });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PROJECTILE });
 	projectile.belongToEnemy = enemyEntity;
 	registry.renderRequests.insert(
 		entity,
@@ -861,6 +329,7 @@ Entity createLine(vec2 position, vec2 scale)
 	motion.scale = scale;
 
 	registry.debugComponents.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::DEBUG });
 	return entity;
 }
 
@@ -883,6 +352,7 @@ Entity createHelp() {
 	
 
 	registry.helpModes.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HELP });
 
 	return entity;
 }
@@ -904,6 +374,7 @@ Entity createStory() {
 	motion.scale = vec2({ STORY_BB_WIDTH * defaultResolution.scaling, STORY_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.storyModes.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::SCREEN });
 
 	return entity;
 }
@@ -925,6 +396,7 @@ Entity createEndScene() {
 	motion.scale = vec2({ STORY_BB_WIDTH * defaultResolution.scaling, STORY_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.storyModes.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::SCREEN });
 
 	return entity;
 }
@@ -946,6 +418,7 @@ Entity createMenu() {
 	motion.scale = vec2({ STORY_BB_WIDTH * defaultResolution.scaling, STORY_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.menuModes.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::SCREEN });
 
 	return entity;
 }
@@ -967,6 +440,8 @@ Entity createHpPowerup(vec2 position) {
 
 	registry.hpPowerup.emplace(entity);
 	Powerup& powerup = registry.powerups.emplace(entity); 
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::POWERUP });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PICKUP });
 	powerup.cost = 5; 
 
 	return entity;
@@ -989,6 +464,8 @@ Entity createDamagePowerup(vec2 position) {
 
 	registry.damagePowerUp.emplace(entity);
 	Powerup& powerup = registry.powerups.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::POWERUP });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PICKUP });
 	powerup.cost = 5;
 
 	return entity;
@@ -1010,6 +487,8 @@ Entity createAttackSpeedPowerup(vec2 position) {
 
 	registry.attackSpeedPowerUp.emplace(entity); 
 	Powerup& powerup = registry.powerups.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::POWERUP });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PICKUP });
 	powerup.cost = 5;
 
 	return entity;
@@ -1032,6 +511,8 @@ Entity createMovementSpeedPowerup(vec2 position) {
 
 	registry.movementSpeedPowerup.emplace(entity);
 	Powerup& powerup = registry.powerups.emplace(entity);
+	registry.colliders.insert(entity, { COLLIDER_CATEGORY::POWERUP });
+	registry.renderLayers.insert(entity, { RENDER_LAYER::PICKUP });
 	powerup.cost = 5;
 
 	return entity;
@@ -1067,6 +548,7 @@ Entity createSingleDigitNumber(vec2 position, int singleDigitNumber) {
 	motion.scale = vec2(NUMBER_BB_WIDTH * defaultResolution.scaling, NUMBER_BB_HEIGHT * defaultResolution.scaling);
 
 	Number& number = registry.numbers.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HUD });
 	number.frame = singleDigitNumber;
 
 	registry.renderRequests.insert(
@@ -1125,6 +607,7 @@ Entity createSmallLetter(vec2 position, int offset) {
 	motion.scale = vec2(SMALLLETTER_BB_WIDTH * defaultResolution.scaling, SMALLLETTER_BB_HEIGHT * defaultResolution.scaling);
 
 	Letter& smolBoi = registry.letters.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HUD });
 	smolBoi.frame = offset; 
 
 	registry.renderRequests.insert(
@@ -1143,6 +626,7 @@ Entity createCapsLetter(vec2 position, int offset) {
 	motion.scale = vec2(CAPSLETTER_BB_WIDTH *defaultResolution.scaling, CAPSLETTER_BB_HEIGHT * defaultResolution.scaling);
 
 	Letter& bigBoi = registry.letters.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HUD });
 	bigBoi.frame = offset;
 
 	registry.renderRequests.insert(
@@ -1172,6 +656,7 @@ Entity createHeadshot(vec2 position, Entity playerEntity) {
 	Motion& motion = registry.motions.emplace(entity);
 	motion.position = position;
 	registry.hudElements.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HUD });
 	if (playerEntity.getId() == registry.players.entities.front()) {
 		motion.scale = vec2(HUD_KNIGHT_HEAD_BB_WIDTH * defaultResolution.scaling, HUD_KNIGHT_HEAD_BB_HEIGHT * defaultResolution.scaling);
 		registry.renderRequests.insert(
@@ -1197,6 +682,7 @@ Entity createCoin(vec2 position) {
 	motion.position = position;
 	motion.scale = vec2(HUD_COIN_BB_WIDTH * defaultResolution.scaling, HUD_COIN_BB_HEIGHT * defaultResolution.scaling);
 	registry.hudElements.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HUD });
 	registry.renderRequests.insert(
 		entity,
 		{ TEXTURE_ASSET_ID::COIN,
@@ -1211,6 +697,7 @@ Entity createHp(vec2 position) {
 	motion.position = position;
 	motion.scale = vec2(HUD_HP_BB_WIDTH * defaultResolution.scaling, HUD_HP_BB_HEIGHT * defaultResolution.scaling);
 	registry.hudElements.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HUD });
 	registry.renderRequests.insert(
 		entity,
 		{ TEXTURE_ASSET_ID::HP,
@@ -1238,6 +725,7 @@ Entity createMovementAndAttackInstructions(vec2 position) {
 	motion.position = position;
 	motion.scale = vec2(TUTORIAL_INSTRUCTIONS_WIDTH * defaultResolution.scaling, TUTORIAL_INSTRUCTIONS_HEIGHT * defaultResolution.scaling);
 	registry.instructions.emplace(entity); 
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HUD });
 
 	registry.renderRequests.insert(
 		entity,
@@ -1253,6 +741,7 @@ Entity createArrow(vec2 position) {
 	motion.position = position;
 	motion.scale = vec2(ARROW_WIDTH * defaultResolution.scaling, ARROW_HEIGHT * defaultResolution.scaling);
 	registry.arrows.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::HUD });
 	registry.renderRequests.insert(
 		entity,
 		{ TEXTURE_ASSET_ID::ARROW,
@@ -18,31 +18,10 @@ const float WATERBALL_BB_WIDTH = 0.04f * 1954.f;
 const float WATERBALL_BB_HEIGHT = 0.04f * 1602.f;
 const float FIREBALL_BB_WIDTH = 0.15f * 328.f;
 const float FIREBALL_BB_HEIGHT = 0.15f * 328.f;
-const float ENEMYBLOB_BB_HEIGHT = 0.3f * 250.f;
-const float ENEMYBLOB_BB_WIDTH = 0.3f * 250.f;
-const float ENEMYRUN_BB_HEIGHT = 0.3f * 240.f;
-const float ENEMYRUN_BB_WIDTH = 0.3f * 240.f;
-const float ENEMYHUNTER_BB_HEIGHT = 0.11f * 691.f;
-const float ENEMYHUNTER_BB_WIDTH = 0.11f * 582.f;
-const float ENEMYBACTERIA_BB_HEIGHT = 0.11f * 691.f;
-const float ENEMYBACTERIA_BB_WIDTH = 0.11f * 800.f;
-const float ENEMYGERM_BB_HEIGHT = 0.11f * 691.f;
-const float ENEMYGERM_BB_WIDTH = 0.11f * 800.f;
-const float ENEMYASTAR_BB_HEIGHT = 0.11f * 550.f;
-const float ENEMYASTAR_BB_WIDTH = 0.11f * 700.f;
-const float ENEMYCHASE_BB_HEIGHT = 0.05f * 1024.f;
-const float ENEMYCHASE_BB_WIDTH = 0.05f * 1258.f;
-const float ENEMYMINION_BB_WH = 0.1f*820.f;
 const float HELP_BB_WIDTH = 800.f;
 const float HELP_BB_HEIGHT = 400.f;
 const float STORY_BB_WIDTH = 0.5*2388.f;
 const float STORY_BB_HEIGHT = 0.5*1668.f;
-const float ENEMYSWARM_BB_WIDTH = 0.14 * 553.f;
-const float ENEMYSWARM_BB_HEIGHT = 0.14 * 411.f;
-const float ENEMYHEAD_BB_WIDTH = 0.2 * 501.f;
-const float ENEMYHEAD_BB_HEIGHT = 0.2 * 450.f;
-const float ENEMYTAIL_BB_WIDTH = 0.25 * 420.f;
-const float ENEMYTAIL_BB_HEIGHT = 0.25 * 420.f;
 const float DAMAGE_POWERUP_WIDTH = 0.0384f * 1954.f;
 const float DAMAGE_POWERUP_HEIGHT = 0.0468f * 1602.f;
 const float MOVEMENT_POWERUP_WIDTH = 0.0366f * 2048.f; 
@@ -73,8 +52,6 @@ const float ARROW_WIDTH = (0.05088195386) * 1474.f;
 const float ARROW_HEIGHT = (0.05572065378f) * 1346.f;
 const float BOSS_BB_WIDTH = 492.f;
 const float BOSS_BB_HEIGHT = 161.f;
-const float HAND_BB_WIDTH = 269.f;
-const float HAND_BB_HEIGHT = 189.f;
 
 
 // background
@@ -114,41 +91,6 @@ Entity createBlock(RenderSystem* renderer, vec2 pos, std::string color);
 
 Entity createDoor(vec2 position, vec2 scale);
 
-Entity createEnemy(RenderSystem* renderer, vec2 position, int enemyType);
-
-// the enemy 
-Entity createEnemyBlob(RenderSystem* renderer, vec2 position);
-
-// Tutorial enemy 
-Entity createTutorialEnemy(RenderSystem* renderer, vec2 position); 
-
-// the enemy that tries to avoid wizards 
-Entity createEnemyRun(RenderSystem* renderer, vec2 position);
-
-// state machine enemy
-Entity createEnemyHunter(RenderSystem* renderer, vec2 position);
-
-// BFS enemy
-Entity createEnemyBacteria(RenderSystem* renderer, vec2 position);
-
-// Chase enemy
-Entity createEnemyChase(RenderSystem* renderer, vec2 position);
-
-// AStar enemy
-Entity createEnemyAStar(RenderSystem* renderer, vec2 position);
-
-// Behaviour Tree enemy
-Entity createEnemyGerm(RenderSystem* renderer, vec2 position);
-
-// Final boss
-Entity createEnemyBoss(RenderSystem* renderer, vec2 position);
-
-// Final boss minions
-Entity createEnemyMinions(RenderSystem* renderer, vec2 position);
-
-// Final boss minions
-Entity createEnemyBossHand(RenderSystem* renderer, vec2 position);
-
 // a red line for debugging purposes
 Entity createLine(vec2 position, vec2 size);
 
@@ -159,15 +101,8 @@ Entity createHelp();
 Entity createStory();
 Entity createEndScene();
 
-// Swarm
-Entity createEnemySwarm(RenderSystem* renderer, vec2 position);
-Entity createEnemySwarmTriplet(RenderSystem* renderer, vec2 position);
 Entity createStory();
 
-// Coord Enemy
-Entity createEnemyCoordHead(RenderSystem* renderer, vec2 position);
-Entity createEnemyCoordTail(RenderSystem* renderer, vec2 position);
-
 // menu
 Entity createMenu();
 Entity createHpPowerup(vec2 position); 
@@ -1,6 +1,9 @@
 // Header
 #include "world_system.hpp"
 #include "world_init.hpp"
+#include "nav_grid.hpp"
+#include "random.hpp"
+#include "prefab.hpp"
 
 // stlib
 #include <cassert>
@@ -15,8 +18,10 @@ WorldSystem::WorldSystem()
 	  firstEntranceToShop(true),
 	  level_number(0)
 {
-	// Seeding rng with random device
-	rng = std::default_random_engine(std::random_device()());
+	// The same seed and inputs replay the same run, so the seed is logged to be passed back in
+	uint64_t seed = pickGameRandomSeed();
+	seedGameRandom(seed);
+	printf("Random seed %llu, set %s to replay this run\n", (unsigned long long)seed, GAME_RANDOM_SEED_VARIABLE);
 	setupWindowScaling();
 }
 
@@ -118,6 +123,7 @@ GLFWwindow* WorldSystem::create_window(int width, int height) {
 	// Load level information 
 	levelFileLoader.readFile(); 
 	levels = levelFileLoader.getLevels(); 
+	enemyPrefabLoader.readFile();
 
 	return window;
 }
@@ -130,6 +136,8 @@ void WorldSystem::init(RenderSystem* renderer_arg) {
 
 // Update our game world
 bool WorldSystem::step(float elapsed_ms_since_last_update) {
+	advanceGameRandom();
+
 	// Remove debug info from the last step
 	while (registry.debugComponents.entities.size() > 0)
 		registry.remove_all_components_of(registry.debugComponents.entities.back());
@@ -209,7 +217,8 @@ void WorldSystem::restart_game() {
 void WorldSystem::createADoor(int screenWidth, int screenHeight) {
 	vec2 doorPosition = { screenWidth / 2 , screenHeight };
 	vec2 doorScale = { screenWidth * doorWidthScale, defaultResolution.shopWallThickness };
-	createDoor(doorPosition, doorScale);
+	Entity door = createDoor(doorPosition, doorScale);
+	addNavObstacle(registry.motions.get(door));
 }
 
 
@@ -447,6 +456,7 @@ void WorldSystem::on_key(int key, int, int action, int mod) {
 			}
 			else {
 				Entity door = registry.doors.entities.front();
+				removeNavObstacle(registry.motions.get(door));
 				registry.remove_all_components_of(door);
 			}
 		}
@@ -1146,6 +1156,7 @@ void WorldSystem::levelCompletionCheck(float elapsed_ms_since_last_update) {
 void WorldSystem::transitionToShop() {
 	if (registry.doors.entities.size() > 0) {
 		Entity door = registry.doors.entities.front();
+		removeNavObstacle(registry.motions.get(door));
 		registry.remove_all_components_of(door);
 		Mix_FadeOutMusic(fade_duration);
 		Mix_PlayChannel(-1, level_end_sound, 0);
@@ -1169,7 +1180,7 @@ void WorldSystem::spawnPowerups(int n) {
 
 	for (int i = 0; i < n; i++) {
 		float xPos = colWidth * (i + 1);
-		Entity powerUpEntity = (level_number == 0) ? chooseFixedPowerUp({ xPos, yPos }, i) : chooseRandomPowerUp({ xPos, yPos });
+		Entity powerUpEntity = (level_number == 0) ? chooseFixedPowerUp({ xPos, yPos }, i) : chooseRandomPowerUp({ xPos, yPos }, i);
 		float priceYPositionAdjustment = scaleCoordinate(70.f); 
 		attachAndRenderPriceNumbers(powerUpEntity, vec2(xPos, yPos + priceYPositionAdjustment));
 	}
@@ -1200,8 +1211,8 @@ Entity WorldSystem::chooseFixedPowerUp(vec2 pos, int index) {
 	}
 }
 
-Entity WorldSystem::chooseRandomPowerUp(vec2 pos) {
-		float random_choice = uniform_dist(rng);
+Entity WorldSystem::chooseRandomPowerUp(vec2 pos, int index) {
+		float random_choice = gameRandom(0, RANDOM_PURPOSE::POWERUP, index);
 		if (random_choice < 0.25f) {
 			return createHpPowerup(pos);
 		}
@@ -1399,6 +1410,16 @@ void WorldSystem::clearLevel() {
 		registry.remove_all_components_of(registry.arrows.entities.back());
 }
 
+// Level positions are in default resolution coordinates, the whole group spawns as one batch
+static void spawnEnemyWave(RenderSystem* renderer, int enemyType, const std::vector<vec2>& levelPositions) {
+	std::vector<vec2> positions;
+	positions.reserve(levelPositions.size());
+	for (vec2 position : levelPositions) {
+		positions.push_back(position * defaultResolution.scaling);
+	}
+	spawnEnemies(renderer, enemyType, positions);
+}
+
 void WorldSystem::setupLevel(int levelNum) {
 	int screen_width, screen_height;
 	glfwGetFramebufferSize(window, &screen_width, &screen_height);
@@ -1406,6 +1427,8 @@ void WorldSystem::setupLevel(int levelNum) {
 	createLevelBackground(levelNum);
 
 	clearLevel();
+	// Geometry created below is stamped all at once by buildNavGrid
+	invalidateNavGrid();
 
 	// Close the door at the start of every level after player leaves the shop. 
 	createADoor(screen_width, screen_height);
@@ -1426,9 +1449,7 @@ void WorldSystem::setupLevel(int levelNum) {
 	}
 	else {
 		for (int i = 0; i < enemyPositions.size(); i++) {
-			for (int j = 0; j < enemyPositions[i].size(); j++) {
-				createEnemy(renderer, enemyPositions[i][j] * defaultResolution.scaling, enemy_types[i]);
-			}
+			spawnEnemyWave(renderer, enemy_types[i], enemyPositions[i]);
 		}
 	}
 	
@@ -1436,10 +1457,11 @@ void WorldSystem::setupLevel(int levelNum) {
 	for (int b = 0; b < level.block_positions.size(); b++) {
 		vec2 block_pos_i = level.block_positions[b];
 		std::string block_color_i;
-		if (uniform_dist(rng) < 0.33) {
+		float colour_choice = gameRandom(0, RANDOM_PURPOSE::BLOCK_COLOUR, b);
+		if (colour_choice < 0.33) {
 			block_color_i = "red";
 		}
-		else if (uniform_dist(rng) >= 0.33 && uniform_dist(rng) < 0.66) {
+		else if (colour_choice < 0.66) {
 			block_color_i = "orange";
 		}
 		else {
@@ -1448,6 +1470,10 @@ void WorldSystem::setupLevel(int levelNum) {
 		createBlock(renderer, block_pos_i * defaultResolution.scaling, block_color_i);
 	}
 
+	// Level geometry is in place, rebuild the nav grid shared by enemy path queries
+	vec2 worldSize = vec2(screen_width, screen_height * gameHeightScale);
+	buildNavGrid(worldSize, NAV_CELL_SIZE * defaultResolution.scaling, NAV_AGENT_RADIUS * defaultResolution.scaling);
+
 	player_knight = createKnight(renderer, level.player_position * defaultResolution.scaling);
 	Player& player1 = registry.players.get(player_knight);
 	player1.playerStat = player_stat;
@@ -1496,6 +1522,7 @@ void WorldSystem::setFinalLevelStages(Level level, BossPhase phase) {
 	auto& motionVoid = registry.motions.emplace(entityWall);
 	motionVoid.position = vec2(600*defaultResolution.scaling, 40*defaultResolution.scaling); // find out better way to pass in position? bossmode
 	motionVoid.scale = vec2({ BACKGROUND_BB_WIDTH * defaultResolution.scaling, BOSS_BB_HEIGHT * defaultResolution.scaling });
+	addNavObstacle(motionVoid);
 
 	if (phase == STAGE1) {
 		createEnemyFilteredByType(level, 9);
@@ -1511,8 +1538,10 @@ void WorldSystem::setFinalLevelStages(Level level, BossPhase phase) {
 	else if (phase == STAGE4) {
 		while (registry.hudElements.entities.size() > 0)
 			registry.remove_all_components_of(registry.hudElements.entities.back());
-		while (registry.blocks.entities.size() > 0)
+		while (registry.blocks.entities.size() > 0) {
+			removeNavObstacle(registry.motions.get(registry.blocks.entities.back()));
 			registry.remove_all_components_of(registry.blocks.entities.back());
+		}
 		while (registry.numbers.entities.size() > 0)
 			registry.remove_all_components_of(registry.numbers.entities.back());
 		while (registry.enemyProjectiles.entities.size() > 0)
@@ -1530,9 +1559,7 @@ void WorldSystem::createEnemyFilteredByType(Level level, int enemyFilter) {
 
 	for (int i = 0; i < enemyPositions.size(); i++) {
 		if (enemy_types[i] == enemyFilter) {
-			for (int j = 0; j < enemyPositions[i].size(); j++) {
-				createEnemy(renderer, enemyPositions[i][j] * defaultResolution.scaling, enemy_types[i]);
-			}
+			spawnEnemyWave(renderer, enemy_types[i], enemyPositions[i]);
 		}
 	}
 
@@ -1703,6 +1730,7 @@ Entity WorldSystem::createMenu() {
 	motion.scale = vec2({ STORY_BB_WIDTH * defaultResolution.scaling, STORY_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.menuModes.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::SCREEN });
 
 	return entity;
 }
@@ -1724,6 +1752,7 @@ Entity WorldSystem::createInGameMenu() {
 	motion.scale = vec2({ STORY_BB_WIDTH * defaultResolution.scaling, STORY_BB_HEIGHT * defaultResolution.scaling });
 
 	registry.menuModes.emplace(entity);
+	registry.renderLayers.insert(entity, { RENDER_LAYER::SCREEN });
 
 	return entity;
 }
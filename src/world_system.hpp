@@ -101,9 +101,6 @@ private:
 	Mix_Music* shop_bgm;
 	Mix_Music* final_boss_bgm;
 	void setLevelMusic(int level);
-	// C++ random number generator
-	std::default_random_engine rng;
-	std::uniform_real_distribution<float> uniform_dist; // number between 0..1
 	// window scaling variables setup
 	void setupWindowScaling();
 	// window scaling variables
@@ -154,7 +151,7 @@ private:
 	void setTransitionFlag(Entity player); 
 	void reviveDeadPlayerInShop(); 
 	void spawnPowerups(int n);
-	Entity chooseRandomPowerUp(vec2 pos);
+	Entity chooseRandomPowerUp(vec2 pos, int index);
 	Entity chooseFixedPowerUp(vec2 pos, int index); 
 	void attachAndRenderPowerupDescription(vec2 pos, std::string type);
 	void drawTutorialTextInShop(); 
@@ -0,0 +1,235 @@
+// Build step that packs the small sprites and sprite sheets of data/textures into a few atlas pages.
+// Usage: atlas_packer <textures dir> <output dir>
+// Writes atlas_<n>.tga pages and atlas.json, the UV table the render system reads at startup.
+// Textures are packed at full resolution unless their TextureFile opts in to a downscale. Textures kept
+// out of the atlas, and any too large for a page, are loaded on their own by the render system.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "texture_files.hpp"
+
+// stlib
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+const int ATLAS_PAGE_SIZE = 2048;
+// Gap between two sprites, filled with their edge pixels so linear filtering never picks up a neighbour
+const int ATLAS_PADDING = 2;
+
+struct Image {
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> pixels;
+};
+
+struct Placement {
+	int id;
+	Image image;
+	int sourceWidth;
+	int sourceHeight;
+	int page = -1;
+	int x = 0;
+	int y = 0;
+};
+
+// Area-weighted downscale. Colour is averaged premultiplied so transparent pixels do not darken the edges
+static Image downscale(const unsigned char* src, int srcWidth, int srcHeight, int width, int height)
+{
+	Image out;
+	out.width = width;
+	out.height = height;
+	out.pixels.resize((size_t)width * height * 4);
+	double sx = (double)srcWidth / width;
+	double sy = (double)srcHeight / height;
+	for (int y = 0; y < height; y++) {
+		double y0 = y * sy, y1 = (y + 1) * sy;
+		for (int x = 0; x < width; x++) {
+			double x0 = x * sx, x1 = (x + 1) * sx;
+			double sum[4] = { 0, 0, 0, 0 };
+			double total = 0;
+			for (int py = (int)y0; py < std::min((int)std::ceil(y1), srcHeight); py++) {
+				double wy = std::min(y1, py + 1.0) - std::max(y0, (double)py);
+				for (int px = (int)x0; px < std::min((int)std::ceil(x1), srcWidth); px++) {
+					double w = wy * (std::min(x1, px + 1.0) - std::max(x0, (double)px));
+					const unsigned char* p = &src[((size_t)py * srcWidth + px) * 4];
+					double alpha = p[3] / 255.0;
+					sum[0] += p[0] * alpha * w;
+					sum[1] += p[1] * alpha * w;
+					sum[2] += p[2] * alpha * w;
+					sum[3] += alpha * w;
+					total += w;
+				}
+			}
+			unsigned char* q = &out.pixels[((size_t)y * width + x) * 4];
+			double alpha = sum[3] / total;
+			for (int c = 0; c < 3; c++) {
+				q[c] = alpha > 0 ? (unsigned char)std::min(255.0, std::round(sum[c] / sum[3])) : 0;
+			}
+			q[3] = (unsigned char)std::round(alpha * 255.0);
+		}
+	}
+	return out;
+}
+
+// Shelf packing, tallest first. Returns the number of pages used
+static int pack(std::vector<Placement>& placements)
+{
+	std::vector<Placement*> order;
+	for (Placement& p : placements) order.push_back(&p);
+	std::sort(order.begin(), order.end(), [](const Placement* a, const Placement* b) {
+		return a->image.height != b->image.height ? a->image.height > b->image.height : a->id < b->id;
+	});
+
+	int page = 0, shelfX = 0, shelfY = 0, shelfHeight = 0;
+	for (Placement* p : order) {
+		int w = p->image.width + 2 * ATLAS_PADDING;
+		int h = p->image.height + 2 * ATLAS_PADDING;
+		if (shelfX + w > ATLAS_PAGE_SIZE) {
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+		if (shelfY + h > ATLAS_PAGE_SIZE) {
+			page++;
+			shelfX = 0;
+			shelfY = 0;
+			shelfHeight = 0;
+		}
+		p->page = page;
+		p->x = shelfX + ATLAS_PADDING;
+		p->y = shelfY + ATLAS_PADDING;
+		shelfX += w;
+		shelfHeight = std::max(shelfHeight, h);
+	}
+	return placements.empty() ? 0 : page + 1;
+}
+
+// Copies the image into the page and extrudes its border into the padding
+static void blit(std::vector<unsigned char>& page, const Placement& p)
+{
+	for (int y = -ATLAS_PADDING; y < p.image.height + ATLAS_PADDING; y++) {
+		int sy = std::min(std::max(y, 0), p.image.height - 1);
+		for (int x = -ATLAS_PADDING; x < p.image.width + ATLAS_PADDING; x++) {
+			int sx = std::min(std::max(x, 0), p.image.width - 1);
+			const unsigned char* src = &p.image.pixels[((size_t)sy * p.image.width + sx) * 4];
+			unsigned char* dst = &page[((size_t)(p.y + y) * ATLAS_PAGE_SIZE + (p.x + x)) * 4];
+			std::copy(src, src + 4, dst);
+		}
+	}
+}
+
+// Uncompressed 32 bit TGA, top-left origin so rows keep the order stbi_load gives the sources
+static bool writeTga(const std::string& path, const std::vector<unsigned char>& rgba)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file) return false;
+	unsigned char header[18] = { 0 };
+	header[2] = 2;
+	header[12] = ATLAS_PAGE_SIZE & 0xff;
+	header[13] = ATLAS_PAGE_SIZE >> 8;
+	header[14] = ATLAS_PAGE_SIZE & 0xff;
+	header[15] = ATLAS_PAGE_SIZE >> 8;
+	header[16] = 32;
+	header[17] = 0x28;
+	fwrite(header, 1, sizeof(header), file);
+	std::vector<unsigned char> bgra(rgba.size());
+	for (size_t i = 0; i < rgba.size(); i += 4) {
+		bgra[i] = rgba[i + 2];
+		bgra[i + 1] = rgba[i + 1];
+		bgra[i + 2] = rgba[i];
+		bgra[i + 3] = rgba[i + 3];
+	}
+	bool ok = fwrite(bgra.data(), 1, bgra.size(), file) == bgra.size();
+	fclose(file);
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 3) {
+		fprintf(stderr, "Usage: atlas_packer <textures dir> <output dir>\n");
+		return 1;
+	}
+	std::string texturesDir = argv[1];
+	std::string outputDir = argv[2];
+
+	std::vector<Placement> placements;
+	const int textureCount = (int)(sizeof(texture_files) / sizeof(texture_files[0]));
+	for (int id = 0; id < textureCount; id++) {
+		const TextureFile& file = texture_files[id];
+		if (!file.inAtlas) continue;
+		std::string path = texturesDir + "/" + file.name;
+		int width, height;
+		unsigned char* data = stbi_load(path.c_str(), &width, &height, NULL, 4);
+		if (data == NULL) {
+			// the render system loads it on its own, and reports it if that fails too
+			fprintf(stderr, "atlas_packer: could not load %s, leaving it out of the atlas\n", path.c_str());
+			continue;
+		}
+		Placement p;
+		p.id = id;
+		p.sourceWidth = width;
+		p.sourceHeight = height;
+		if (file.atlasDownscale > 0 && std::max(width, height) > file.atlasDownscale) {
+			float scale = (float)file.atlasDownscale / std::max(width, height);
+			int atlasWidth = std::max(1, (int)std::round(width * scale));
+			int atlasHeight = std::max(1, (int)std::round(height * scale));
+			p.image = downscale(data, width, height, atlasWidth, atlasHeight);
+		}
+		else {
+			p.image.width = width;
+			p.image.height = height;
+			p.image.pixels.assign(data, data + (size_t)width * height * 4);
+		}
+		stbi_image_free(data);
+		if (std::max(p.image.width, p.image.height) + 2 * ATLAS_PADDING > ATLAS_PAGE_SIZE) {
+			fprintf(stderr, "atlas_packer: %s is %d x %d, too large for a page, leaving it out of the atlas\n", file.name, p.image.width, p.image.height);
+			continue;
+		}
+		if (p.image.width != width) {
+			printf("atlas_packer: %s downscaled from %d x %d to %d x %d\n", file.name, width, height, p.image.width, p.image.height);
+		}
+		placements.push_back(std::move(p));
+	}
+
+	int pageCount = pack(placements);
+	std::vector<std::string> pageNames;
+	for (int page = 0; page < pageCount; page++) {
+		std::vector<unsigned char> pixels((size_t)ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4, 0);
+		for (const Placement& p : placements) {
+			if (p.page == page) blit(pixels, p);
+		}
+		pageNames.push_back("atlas_" + std::to_string(page) + ".tga");
+		if (!writeTga(outputDir + "/" + pageNames.back(), pixels)) {
+			fprintf(stderr, "atlas_packer: could not write %s\n", pageNames.back().c_str());
+			return 1;
+		}
+	}
+
+	std::string tablePath = outputDir + "/atlas.json";
+	FILE* table = fopen(tablePath.c_str(), "w");
+	if (!table) {
+		fprintf(stderr, "atlas_packer: could not write %s\n", tablePath.c_str());
+		return 1;
+	}
+	fprintf(table, "{\n\t\"page_size\": %d,\n\t\"pages\": [", ATLAS_PAGE_SIZE);
+	for (int page = 0; page < pageCount; page++) {
+		fprintf(table, "%s\"%s\"", page ? ", " : "", pageNames[page].c_str());
+	}
+	fprintf(table, "],\n\t\"textures\": [\n");
+	for (size_t i = 0; i < placements.size(); i++) {
+		const Placement& p = placements[i];
+		fprintf(table, "\t\t{ \"id\": %d, \"file\": \"%s\", \"page\": %d, \"x\": %d, \"y\": %d, \"width\": %d, \"height\": %d, \"source_width\": %d, \"source_height\": %d }%s\n",
+			p.id, texture_files[p.id].name, p.page, p.x, p.y, p.image.width, p.image.height, p.sourceWidth, p.sourceHeight,
+			i + 1 < placements.size() ? "," : "");
+	}
+	fprintf(table, "\t]\n}\n");
+	fclose(table);
+
+	printf("atlas_packer: %d textures on %d pages of %d x %d\n", (int)placements.size(), pageCount, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+	return 0;
+}